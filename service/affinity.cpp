@@ -0,0 +1,289 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#ifdef __linux__
+#  include <linux/mempolicy.h>
+#endif
+
+#include <algorithm>
+#include <sstream>
+#include <system_error>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "affinity.hpp"
+
+namespace ba = boost::algorithm;
+
+namespace service {
+
+namespace {
+
+/** Maximum number of NUMA nodes we handle.
+ */
+constexpr int MaxNodes = 1024;
+
+constexpr int LongBits = 8 * sizeof(unsigned long);
+
+int parseIndex(const std::string &list, const std::string &value)
+{
+    try {
+        auto index(boost::lexical_cast<int>(ba::trim_copy(value)));
+        if (index >= 0) { return index; }
+    } catch (const boost::bad_lexical_cast&) {}
+
+    LOGTHROW(err2, std::runtime_error)
+        << "Invalid cpu list <" << list << ">.";
+    throw;
+}
+
+} // namespace
+
+CpuList::CpuList(std::vector<int> cpus)
+    : cpus_(std::move(cpus))
+{
+    std::sort(cpus_.begin(), cpus_.end());
+    cpus_.erase(std::unique(cpus_.begin(), cpus_.end()), cpus_.end());
+}
+
+CpuList CpuList::parse(const std::string &list)
+{
+    std::vector<int> cpus;
+
+    std::istringstream is(list);
+    std::string item;
+    while (std::getline(is, item, ',')) {
+        if (ba::trim_copy(item).empty()) { continue; }
+
+        const auto dash(item.find('-'));
+        const auto first(parseIndex(list, item.substr(0, dash)));
+        const auto last((dash == std::string::npos)
+                        ? first : parseIndex(list, item.substr(dash + 1)));
+        if (last < first) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Invalid cpu list <" << list << ">.";
+        }
+
+        for (auto i(first); i <= last; ++i) { cpus.push_back(i); }
+    }
+
+    return CpuList(std::move(cpus));
+}
+
+std::string CpuList::str() const
+{
+    std::ostringstream os;
+    bool first(true);
+    for (auto i(cpus_.begin()), e(cpus_.end()); i != e; ) {
+        auto j(i);
+        while (((j + 1) != e) && (*(j + 1) == (*j + 1))) { ++j; }
+
+        if (first) { first = false; } else { os << ','; }
+        os << *i;
+        if (j != i) { os << '-' << *j; }
+        i = j + 1;
+    }
+    return os.str();
+}
+
+std::ostream& operator<<(std::ostream &os, const CpuList &cpus)
+{
+    return os << cpus.str();
+}
+
+#ifdef __linux__
+
+CpuList CpuList::allowed()
+{
+    ::cpu_set_t set;
+    CPU_ZERO(&set);
+    if (-1 == ::sched_getaffinity(0, sizeof(set), &set)) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot get CPU affinity: <" << e.what() << ">.";
+        throw e;
+    }
+
+    std::vector<int> cpus;
+    for (int cpu(0); cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) { cpus.push_back(cpu); }
+    }
+    return CpuList(std::move(cpus));
+}
+
+void setAffinity(const CpuList &cpus)
+{
+    ::cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus.cpus()) {
+        if (cpu >= CPU_SETSIZE) {
+            LOGTHROW(err2, std::runtime_error)
+                << "CPU " << cpu << " out of supported range.";
+        }
+        CPU_SET(cpu, &set);
+    }
+
+    if (-1 == ::sched_setaffinity(0, sizeof(set), &set)) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot set CPU affinity to <" << cpus << ">: <"
+                  << e.what() << ">.";
+        throw e;
+    }
+}
+
+namespace {
+
+int mpolMode(NumaPolicy policy)
+{
+    switch (policy) {
+    case NumaPolicy::defaultPolicy: return MPOL_DEFAULT;
+    case NumaPolicy::bind: return MPOL_BIND;
+    case NumaPolicy::preferred: return MPOL_PREFERRED;
+    case NumaPolicy::interleave: return MPOL_INTERLEAVE;
+    case NumaPolicy::local: return MPOL_LOCAL;
+    }
+    return MPOL_DEFAULT;
+}
+
+} // namespace
+
+void setNumaPolicy(NumaPolicy policy, const CpuList &nodes)
+{
+    std::vector<unsigned long> mask(MaxNodes / LongBits, 0);
+    for (auto node : nodes.cpus()) {
+        if (node >= MaxNodes) {
+            LOGTHROW(err2, std::runtime_error)
+                << "NUMA node " << node << " out of supported range.";
+        }
+        mask[node / LongBits] |= (1ul << (node % LongBits));
+    }
+
+    const bool useMask((policy != NumaPolicy::defaultPolicy)
+                       && (policy != NumaPolicy::local));
+
+    if (-1 == ::syscall(SYS_set_mempolicy, mpolMode(policy)
+                        , useMask ? mask.data() : nullptr
+                        , useMask ? (MaxNodes + 1) : 0))
+    {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot set NUMA policy <" << asString(policy)
+                  << "> for nodes <" << nodes << ">: <"
+                  << e.what() << ">.";
+        throw e;
+    }
+}
+
+NumaPlacement numaPlacement()
+{
+    std::vector<unsigned long> mask(MaxNodes / LongBits, 0);
+    int mode(0);
+    if (-1 == ::syscall(SYS_get_mempolicy, &mode, mask.data()
+                        , MaxNodes + 1, nullptr, 0))
+    {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot get NUMA policy: <" << e.what() << ">.";
+        throw e;
+    }
+
+    NumaPlacement out;
+    switch (mode & ~(MPOL_F_STATIC_NODES | MPOL_F_RELATIVE_NODES)) {
+    case MPOL_BIND: out.policy = NumaPolicy::bind; break;
+    case MPOL_PREFERRED: out.policy = NumaPolicy::preferred; break;
+    case MPOL_INTERLEAVE: out.policy = NumaPolicy::interleave; break;
+    case MPOL_LOCAL: out.policy = NumaPolicy::local; break;
+    default: out.policy = NumaPolicy::defaultPolicy; break;
+    }
+
+    std::vector<int> nodes;
+    for (int node(0); node < MaxNodes; ++node) {
+        if (mask[node / LongBits] & (1ul << (node % LongBits))) {
+            nodes.push_back(node);
+        }
+    }
+    out.nodes = CpuList(std::move(nodes));
+    return out;
+}
+
+#else // !__linux__
+
+CpuList CpuList::allowed()
+{
+    std::vector<int> cpus;
+    const auto count(::sysconf(_SC_NPROCESSORS_ONLN));
+    for (long cpu(0); cpu < count; ++cpu) { cpus.push_back(cpu); }
+    return CpuList(std::move(cpus));
+}
+
+void setAffinity(const CpuList&)
+{
+    LOGTHROW(err2, std::runtime_error)
+        << "CPU affinity not supported on this platform.";
+}
+
+void setNumaPolicy(NumaPolicy, const CpuList&)
+{
+    LOGTHROW(err2, std::runtime_error)
+        << "NUMA policy not supported on this platform.";
+}
+
+NumaPlacement numaPlacement()
+{
+    return {};
+}
+
+#endif // __linux__
+
+NumaPolicy parseNumaPolicy(const std::string &policy)
+{
+    if (policy == "default") { return NumaPolicy::defaultPolicy; }
+    if (policy == "bind") { return NumaPolicy::bind; }
+    if (policy == "preferred") { return NumaPolicy::preferred; }
+    if (policy == "interleave") { return NumaPolicy::interleave; }
+    if (policy == "local") { return NumaPolicy::local; }
+
+    LOGTHROW(err2, std::runtime_error)
+        << "Invalid NUMA policy <" << policy << ">.";
+    throw;
+}
+
+const char* asString(NumaPolicy policy)
+{
+    switch (policy) {
+    case NumaPolicy::defaultPolicy: return "default";
+    case NumaPolicy::bind: return "bind";
+    case NumaPolicy::preferred: return "preferred";
+    case NumaPolicy::interleave: return "interleave";
+    case NumaPolicy::local: return "local";
+    }
+    return "unknown";
+}
+
+} // namespace service
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_affinity_hpp_included_
+#define shared_service_affinity_hpp_included_
+
+#include <vector>
+#include <string>
+#include <iosfwd>
+
+namespace service {
+
+/** Sorted list of CPU (or NUMA node) indices, textual form is the cpulist
+ *  format used by the kernel (e.g. "0-3,8,10-11").
+ */
+class CpuList {
+public:
+    CpuList() {}
+
+    explicit CpuList(std::vector<int> cpus);
+
+    static CpuList parse(const std::string &list);
+
+    /** CPUs the calling thread is allowed to run on.
+     */
+    static CpuList allowed();
+
+    bool empty() const { return cpus_.empty(); }
+    std::size_t size() const { return cpus_.size(); }
+    int operator[](std::size_t index) const { return cpus_[index]; }
+
+    const std::vector<int>& cpus() const { return cpus_; }
+
+    std::string str() const;
+
+private:
+    std::vector<int> cpus_;
+};
+
+std::ostream& operator<<(std::ostream &os, const CpuList &cpus);
+
+/** Restricts calling thread (and threads/processes created afterwards) to
+ *  given CPUs.
+ */
+void setAffinity(const CpuList &cpus);
+
+enum class NumaPolicy { defaultPolicy, bind, preferred, interleave, local };
+
+NumaPolicy parseNumaPolicy(const std::string &policy);
+
+const char* asString(NumaPolicy policy);
+
+/** Sets memory policy of calling thread (inherited by threads/processes
+ *  created afterwards).
+ */
+void setNumaPolicy(NumaPolicy policy, const CpuList &nodes);
+
+struct NumaPlacement {
+    NumaPolicy policy;
+    CpuList nodes;
+
+    NumaPlacement() : policy(NumaPolicy::defaultPolicy) {}
+};
+
+/** Queries memory policy of calling thread.
+ */
+NumaPlacement numaPlacement();
+
+} // namespace service
+
+#endif // shared_service_affinity_hpp_included_
@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "cancellation.hpp"
+
+namespace service {
+
+struct CancellationToken::State {
+    std::atomic<bool> cancelled;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::map<std::uint64_t, std::function<void()> > callbacks;
+    std::uint64_t nextId;
+
+    /** Callback being run at the moment and thread running it.
+     */
+    std::uint64_t running;
+    std::thread::id runner;
+
+    std::vector<std::weak_ptr<State> > children;
+
+    State() : cancelled(false), nextId(1), running() {}
+
+    void cancel();
+    void unregister(std::uint64_t id);
+};
+
+void CancellationToken::State::cancel()
+{
+    std::vector<std::weak_ptr<State> > children;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (cancelled.exchange(true)) { return; }
+
+        // run callbacks one by one outside the lock
+        runner = std::this_thread::get_id();
+        while (!callbacks.empty()) {
+            auto fcallbacks(callbacks.begin());
+            running = fcallbacks->first;
+            auto callback(std::move(fcallbacks->second));
+            callbacks.erase(fcallbacks);
+
+            lock.unlock();
+            callback();
+            lock.lock();
+
+            running = 0;
+            cond.notify_all();
+        }
+
+        children.swap(this->children);
+    }
+
+    for (const auto &child : children) {
+        if (auto state = child.lock()) { state->cancel(); }
+    }
+}
+
+void CancellationToken::State::unregister(std::uint64_t id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (callbacks.erase(id)) { return; }
+
+    // callback may be running right now; wait unless it is us who run it
+    if (runner != std::this_thread::get_id()) {
+        cond.wait(lock, [&]() { return running != id; });
+    }
+}
+
+CancellationToken::CancellationToken()
+    : state_(std::make_shared<State>())
+    , cancelled_(&state_->cancelled)
+{}
+
+CancellationToken CancellationToken::child() const
+{
+    CancellationToken token;
+    {
+        std::lock_guard<std::mutex> guard(state_->mutex);
+        if (!state_->cancelled) {
+            auto &children(state_->children);
+
+            // drop dead children
+            children.erase(std::remove_if
+                           (children.begin(), children.end()
+                            , [](const std::weak_ptr<State> &c) {
+                               return c.expired();
+                           })
+                           , children.end());
+
+            children.push_back(token.state_);
+            return token;
+        }
+    }
+
+    token.state_->cancelled = true;
+    return token;
+}
+
+void CancellationToken::cancel() const
+{
+    state_->cancel();
+}
+
+CancellationToken::Registration
+CancellationToken::onCancel(std::function<void()> callback) const
+{
+    {
+        std::lock_guard<std::mutex> guard(state_->mutex);
+        if (!state_->cancelled) {
+            const auto id(state_->nextId++);
+            state_->callbacks.insert
+                (std::make_pair(id, std::move(callback)));
+            return Registration(state_, id);
+        }
+    }
+
+    callback();
+    return Registration();
+}
+
+CancellationToken::Registration&
+CancellationToken::Registration::operator=(Registration &&other)
+{
+    if (this != &other) {
+        reset();
+        state_ = std::move(other.state_);
+        id_ = other.id_;
+    }
+    return *this;
+}
+
+void CancellationToken::Registration::reset()
+{
+    if (!state_) { return; }
+    state_->unregister(id_);
+    state_.reset();
+}
+
+} // namespace service
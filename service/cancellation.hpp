@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_cancellation_hpp_included_
+#define service_cancellation_hpp_included_
+
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "utility/runnable.hpp"
+
+namespace service {
+
+/** Cooperative cancellation flag shared by all copies of a token.
+ *
+ *  Tokens form a tree: child() returns a token that is cancelled together
+ *  with its parent (eagerly, at parent's cancel()) but can also be
+ *  cancelled on its own without affecting the parent. Checking the flag is a
+ *  single relaxed atomic load.
+ *
+ *  Blocking operations can register a callback (e.g. closing a socket,
+ *  notifying a condition variable) run on cancellation.
+ */
+class CancellationToken {
+public:
+    struct State;
+
+    /** Callback registration; unregisters on destruction. If the callback
+     *  is being run by another thread, destruction waits for it to finish.
+     */
+    class Registration {
+    public:
+        Registration() : id_() {}
+        Registration(Registration &&other)
+            : state_(std::move(other.state_)), id_(other.id_) {}
+        Registration& operator=(Registration &&other);
+        ~Registration() { reset(); }
+
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+        void reset();
+
+    private:
+        friend class CancellationToken;
+        Registration(const std::shared_ptr<State> &state, std::uint64_t id)
+            : state_(state), id_(id) {}
+
+        std::shared_ptr<State> state_;
+        std::uint64_t id_;
+    };
+
+    /** Adapter to utility::Runnable, see below.
+     */
+    class Runnable;
+
+    /** Creates new root token.
+     */
+    CancellationToken();
+
+    /** Creates token cancelled together with this one. Child of a cancelled
+     *  token is created cancelled.
+     */
+    CancellationToken child() const;
+
+    bool cancelled() const {
+        return cancelled_->load(std::memory_order_relaxed);
+    }
+
+    /** Cancels this token and all its descendants and runs their
+     *  callbacks (in calling thread). Idempotent.
+     */
+    void cancel() const;
+
+    /** Registers callback run once on cancellation; runs it immediately
+     *  when already cancelled. Callback must not throw.
+     */
+    Registration onCancel(std::function<void()> callback) const;
+
+private:
+    std::shared_ptr<State> state_;
+
+    /** Points into state_, avoids one indirection in cancelled().
+     */
+    const std::atomic<bool> *cancelled_;
+};
+
+/** Adapter for code taking utility::Runnable (e.g. PipeNotifier):
+ *  isRunning() is true until the token is cancelled, stop() cancels it.
+ */
+class CancellationToken::Runnable : public utility::Runnable {
+public:
+    Runnable(const CancellationToken &token) : token_(token) {}
+
+    bool isRunning() override { return !token_.cancelled(); }
+    void stop() override { token_.cancel(); }
+
+    const CancellationToken& token() const { return token_; }
+
+private:
+    CancellationToken token_;
+};
+
+} // namespace service
+
+#endif // service_cancellation_hpp_included_
@@ -0,0 +1,499 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <condition_variable>
+
+#include "dbglog/dbglog.hpp"
+
+#include "components.hpp"
+#include "threadregistry.hpp"
+
+namespace service {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+long ms(const Clock::duration &d)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+} // namespace
+
+struct Components::Detail
+    : std::enable_shared_from_this<Components::Detail>
+{
+    enum class State { registered, queued, running, started, failed
+                       , skipped, stopping, stopped, abandoned };
+
+    struct Component {
+        std::string name;
+        std::vector<std::string> dependencies;
+        Start start;
+        Stop stop;
+        Timeout stopTimeout;
+
+        /** Indices of components depending on this one.
+         */
+        std::vector<std::size_t> dependents;
+
+        /** Number of not yet started dependencies.
+         */
+        std::size_t waiting;
+
+        State state;
+        Clock::duration offset;
+        Clock::duration duration;
+        std::string error;
+
+        /** Number of started dependents not yet stopped, stop start time
+         *  and stop result (set by stopping thread).
+         */
+        std::size_t blockers;
+        Clock::time_point stopBegin;
+        bool stopDone;
+
+        Component(const std::string &name
+                  , const std::vector<std::string> &dependencies
+                  , const Start &start, const Stop &stop
+                  , Timeout stopTimeout)
+            : name(name), dependencies(dependencies)
+            , start(start), stop(stop), stopTimeout(stopTimeout)
+            , waiting(), state(State::registered)
+            , offset(), duration(), blockers(), stopDone()
+        {}
+    };
+
+    void resolve();
+    void launch(std::size_t index);
+    void run(std::size_t index);
+    void launchStop(std::size_t index);
+
+    std::vector<Component> components;
+    std::map<std::string, std::size_t> names;
+
+    mutable std::mutex mutex;
+    std::condition_variable cond;
+
+    // startup state, valid during start()
+    Executor *executor;
+    CancellationToken token;
+    Clock::time_point since;
+    std::size_t queued;
+    std::size_t running;
+    bool aborted;
+    std::exception_ptr failure;
+
+    /** Completion order, stop() goes backwards.
+     */
+    std::vector<std::size_t> order;
+
+    Detail() : executor(), queued(), running(), aborted() {}
+};
+
+namespace {
+
+const char* asString(Components::Detail::State state)
+{
+    typedef Components::Detail::State State;
+    switch (state) {
+    case State::registered: return "registered";
+    case State::queued: return "queued";
+    case State::running: return "starting";
+    case State::started: return "started";
+    case State::failed: return "failed";
+    case State::skipped: return "skipped";
+    case State::stopping: return "stopping";
+    case State::stopped: return "stopped";
+    case State::abandoned: return "did not stop in time";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+void Components::Detail::resolve()
+{
+    for (std::size_t i(0); i < components.size(); ++i) {
+        auto &component(components[i]);
+        component.dependents.clear();
+        component.waiting = component.dependencies.size();
+    }
+
+    for (std::size_t i(0); i < components.size(); ++i) {
+        for (const auto &dependency : components[i].dependencies) {
+            auto fnames(names.find(dependency));
+            if (fnames == names.end()) {
+                LOGTHROW(err3, std::logic_error)
+                    << "Component <" << components[i].name
+                    << "> depends on unknown component <"
+                    << dependency << ">.";
+            }
+            components[fnames->second].dependents.push_back(i);
+        }
+    }
+
+    // detect cycles (Kahn's algorithm)
+    std::vector<std::size_t> waiting, ready;
+    for (const auto &component : components) {
+        waiting.push_back(component.waiting);
+        if (!component.waiting) { ready.push_back(waiting.size() - 1); }
+    }
+    std::size_t visited(0);
+    while (!ready.empty()) {
+        const auto index(ready.back());
+        ready.pop_back();
+        ++visited;
+        for (auto dependent : components[index].dependents) {
+            if (!--waiting[dependent]) { ready.push_back(dependent); }
+        }
+    }
+
+    if (visited != components.size()) {
+        LOGTHROW(err3, std::logic_error)
+            << "Component dependencies contain a cycle.";
+    }
+}
+
+/** Must be called under lock.
+ */
+void Components::Detail::launch(std::size_t index)
+{
+    auto &component(components[index]);
+    component.state = State::queued;
+    ++queued;
+
+    auto self(shared_from_this());
+    if (!executor->post([self, index]() { self->run(index); })) {
+        // executor is going down
+        component.state = State::skipped;
+        --queued;
+        aborted = true;
+    }
+}
+
+void Components::Detail::run(std::size_t index)
+{
+    auto &component(components[index]);
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        --queued;
+        if (token.cancelled()) { aborted = true; }
+        if (aborted) {
+            component.state = State::skipped;
+            cond.notify_all();
+            return;
+        }
+        component.state = State::running;
+        component.offset = Clock::now() - since;
+        ++running;
+    }
+
+    LOG(info2) << "Starting component <" << component.name << ">.";
+
+    const auto start(Clock::now());
+    std::exception_ptr error;
+    std::string what;
+    try {
+        if (component.start) { component.start(token); }
+    } catch (const std::exception &e) {
+        what = e.what();
+        error = std::current_exception();
+    } catch (...) {
+        what = "unknown exception";
+        error = std::current_exception();
+    }
+    const auto duration(Clock::now() - start);
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        --running;
+        component.duration = duration;
+        if (token.cancelled()) { aborted = true; }
+
+        if (error) {
+            component.state = State::failed;
+            component.error = what;
+            LOG(err3) << "Component <" << component.name << "> failed after "
+                      << ms(duration) << " ms: <" << component.error << ">.";
+            if (!aborted) {
+                aborted = true;
+                failure = error;
+            }
+        } else {
+            component.state = State::started;
+            order.push_back(index);
+            LOG(info3) << "Component <" << component.name
+                       << "> started in " << ms(duration) << " ms.";
+
+            if (!aborted) {
+                for (auto dependent : component.dependents) {
+                    if (!--components[dependent].waiting) {
+                        launch(dependent);
+                    }
+                }
+            }
+        }
+
+        cond.notify_all();
+    }
+
+    // let running siblings know
+    if (error) { token.cancel(); }
+}
+
+/** Must be called under lock.
+ */
+void Components::Detail::launchStop(std::size_t index)
+{
+    auto &component(components[index]);
+    component.state = State::stopping;
+    component.stopBegin = Clock::now();
+    component.stopDone = false;
+
+    LOG(info2) << "Stopping component <" << component.name << ">.";
+
+    // detached: may be abandoned when over deadline
+    auto self(shared_from_this());
+    std::thread([self, index]()
+    {
+        auto &component(self->components[index]);
+        auto registration(registerThread("stop-" + component.name
+                                         , "shutdown"));
+        if (component.stop) {
+            try {
+                component.stop();
+            } catch (const std::exception &e) {
+                LOG(err3) << "Failed to stop component <" << component.name
+                          << ">: <" << e.what() << ">.";
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(self->mutex);
+        component.stopDone = true;
+        self->cond.notify_all();
+    }).detach();
+}
+
+constexpr Components::Timeout Components::DefaultStopTimeout;
+
+Components::Components()
+    : detail_(std::make_shared<Detail>())
+{}
+
+Components::~Components() {}
+
+void Components::add(const std::string &name
+                     , const std::vector<std::string> &dependencies
+                     , const Start &start, const Stop &stop
+                     , Timeout stopTimeout)
+{
+    auto &d(detail());
+    std::lock_guard<std::mutex> guard(d.mutex);
+    if (d.executor) {
+        LOGTHROW(err3, std::logic_error)
+            << "Component <" << name << "> registered after startup.";
+    }
+    if (d.names.count(name)) {
+        LOGTHROW(err3, std::logic_error)
+            << "Component <" << name << "> already registered.";
+    }
+
+    d.names.insert(std::make_pair(name, d.components.size()));
+    d.components.emplace_back(name, dependencies, start, stop, stopTimeout);
+}
+
+bool Components::empty() const
+{
+    std::lock_guard<std::mutex> guard(detail().mutex);
+    return detail().components.empty();
+}
+
+void Components::start(Executor &executor, const CancellationToken &token
+                       , utility::Runnable &runnable)
+{
+    auto &d(detail());
+
+    std::unique_lock<std::mutex> lock(d.mutex);
+    d.resolve();
+
+    d.executor = &executor;
+    d.token = token.child();
+    d.since = Clock::now();
+    d.queued = d.running = 0;
+    d.aborted = false;
+    d.failure = nullptr;
+    d.order.clear();
+
+    LOG(info3) << "Starting " << d.components.size() << " components on "
+               << executor.size() << " threads.";
+
+    for (std::size_t i(0); i < d.components.size(); ++i) {
+        if (!d.components[i].waiting) { d.launch(i); }
+    }
+
+    // wait for completion or abort; termination does not notify us
+    for (;;) {
+        if (!d.running && (!d.queued || d.aborted)) { break; }
+        if (d.token.cancelled()) { d.aborted = true; }
+        if (d.cond.wait_for(lock, std::chrono::milliseconds(100))
+            == std::cv_status::timeout)
+        {
+            lock.unlock();
+            if (!runnable.isRunning()) { d.token.cancel(); }
+            lock.lock();
+        }
+    }
+
+    const auto elapsed(Clock::now() - d.since);
+    Clock::duration total(0);
+    for (const auto &component : d.components) {
+        total += component.duration;
+    }
+
+    if (!d.aborted && (d.order.size() == d.components.size())) {
+        LOG(info3) << "All components started in " << ms(elapsed)
+                   << " ms (" << ms(total) << " ms in total).";
+        return;
+    }
+
+    // anything that did not get to run is skipped; prevent queued tasks
+    // from starting
+    d.aborted = true;
+    for (auto &component : d.components) {
+        if ((component.state == Detail::State::registered)
+            || (component.state == Detail::State::queued))
+        {
+            component.state = Detail::State::skipped;
+        }
+    }
+    auto failure(d.failure);
+    lock.unlock();
+
+    LOG(err3) << "Component startup aborted after " << ms(elapsed)
+              << " ms, stopping started components.";
+    stop();
+
+    if (failure) { std::rethrow_exception(failure); }
+    LOGTHROW(err3, std::runtime_error)
+        << "Component startup cancelled.";
+}
+
+void Components::stop()
+{
+    auto &d(detail());
+    typedef Detail::State State;
+
+    std::unique_lock<std::mutex> lock(d.mutex);
+    if (d.order.empty()) { return; }
+
+    const auto since(Clock::now());
+
+    // count started dependents of each started component
+    for (auto index : d.order) { d.components[index].blockers = 0; }
+    for (auto index : d.order) {
+        for (const auto &dependency : d.components[index].dependencies) {
+            ++d.components[d.names[dependency]].blockers;
+        }
+    }
+
+    std::size_t remaining(d.order.size());
+    for (auto index : d.order) {
+        if (!d.components[index].blockers) { d.launchStop(index); }
+    }
+    auto started(std::move(d.order));
+    d.order.clear();
+
+    while (remaining) {
+        const auto now(Clock::now());
+        auto wakeup(now + std::chrono::seconds(1));
+
+        for (auto index : started) {
+            auto &component(d.components[index]);
+            if (component.state != State::stopping) { continue; }
+
+            const auto deadline(component.stopBegin + component.stopTimeout);
+            const auto duration(now - component.stopBegin);
+            if (component.stopDone) {
+                component.state = State::stopped;
+                LOG(info3) << "Component <" << component.name
+                           << "> stopped in " << ms(duration) << " ms.";
+            } else if (now >= deadline) {
+                component.state = State::abandoned;
+                LOG(err3) << "Component <" << component.name
+                          << "> did not stop within "
+                          << component.stopTimeout.count()
+                          << " ms, abandoning.";
+            } else {
+                wakeup = std::min(wakeup, deadline);
+                continue;
+            }
+
+            --remaining;
+
+            // dependencies may go down when all their dependents are down
+            for (const auto &dependency : component.dependencies) {
+                const auto dindex(d.names[dependency]);
+                if (!--d.components[dindex].blockers) {
+                    d.launchStop(dindex);
+                }
+            }
+        }
+
+        if (remaining) { d.cond.wait_until(lock, wakeup); }
+    }
+
+    LOG(info3) << "Components stopped in " << ms(Clock::now() - since)
+               << " ms.";
+}
+
+void Components::monitor(std::ostream &os, const std::string &prefix) const
+{
+    const auto &d(detail());
+    std::lock_guard<std::mutex> guard(d.mutex);
+
+    for (const auto &component : d.components) {
+        os << prefix << component.name << ": "
+           << asString(component.state);
+        if (component.duration.count()) {
+            os << ", start at +" << ms(component.offset) << " ms took "
+               << ms(component.duration) << " ms";
+        }
+        if (!component.error.empty()) {
+            os << " (" << component.error << ")";
+        }
+        os << "\n";
+    }
+}
+
+} // namespace service
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_components_hpp_included_
+#define service_components_hpp_included_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <ostream>
+#include <functional>
+
+#include "executor.hpp"
+#include "cancellation.hpp"
+
+namespace service {
+
+/** Named service components with dependencies.
+ *
+ *  Components are started concurrently on a thread pool as a DAG: a
+ *  component is started as soon as all its dependencies are started.
+ *  First failure cancels the startup token, no further component is
+ *  started and already started components are stopped.
+ *
+ *  Components are stopped in parallel in reverse order: a component is
+ *  stopped (in its own thread) only after all started components depending
+ *  on it were stopped. A component that does not stop within its deadline
+ *  is abandoned (its thread is left running) and treated as stopped.
+ */
+class Components {
+public:
+    /** Start function; should return early when the token is cancelled.
+     */
+    typedef std::function<void(const CancellationToken &token)> Start;
+
+    typedef std::function<void()> Stop;
+
+    typedef std::chrono::milliseconds Timeout;
+
+    static constexpr Timeout DefaultStopTimeout = Timeout(30000);
+
+    Components();
+    ~Components();
+
+    /** Registers component. Dependencies are validated by start().
+     */
+    void add(const std::string &name
+             , const std::vector<std::string> &dependencies
+             , const Start &start, const Stop &stop = Stop()
+             , Timeout stopTimeout = DefaultStopTimeout);
+
+    bool empty() const;
+
+    /** Starts all components on given executor and waits until all are
+     *  started. Components get a child of given token.
+     *
+     *  Start functions occupy executor threads while they run: a start
+     *  function must not wait for tasks posted to the same executor, or
+     *  startup can deadlock once all threads are taken by waiting starts.
+     *  Use a dedicated executor (Service does) when components need a
+     *  shared pool during startup.
+     * Startup is aborted
+     *  when the token is cancelled; runnable is polled while waiting so
+     *  that termination can be detected (Service::isRunning() cancels its
+     *  root token).
+     *
+     *  Throws first failure (or std::runtime_error when cancelled); throws
+     *  std::logic_error on unknown dependency or dependency cycle.
+     */
+    void start(Executor &executor, const CancellationToken &token
+               , utility::Runnable &runnable);
+
+    /** Stops started components and waits until they are stopped (or
+     *  abandoned). Idempotent.
+     */
+    void stop();
+
+    /** Prints per-component state and start timing, one "Key: value" per
+     *  line prefixed with given prefix.
+     */
+    void monitor(std::ostream &os, const std::string &prefix = "Component-")
+        const;
+
+    struct Detail;
+
+private:
+    std::shared_ptr<Detail> detail_;
+    Detail& detail() { return *detail_; }
+    const Detail& detail() const { return *detail_; }
+};
+
+} // namespace service
+
+#endif // service_components_hpp_included_
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include "ctrlbatch.hpp"
+
+namespace ba = boost::algorithm;
+
+namespace service {
+
+std::vector<std::string> CtrlBatch::load(std::istream &is)
+{
+    std::vector<std::string> commands;
+
+    std::string line;
+    while (std::getline(is, line)) {
+        ba::trim(line);
+        if (line.empty() || (line.front() == '#')) { continue; }
+        commands.push_back(line);
+    }
+
+    return commands;
+}
+
+int CtrlBatch::run(CtrlClientBase &client
+                   , const std::vector<std::string> &commands
+                   , std::ostream &os, std::ostream &err) const
+{
+    std::size_t failed(0);
+    std::size_t done(0);
+
+    // never send ahead of a reply that can stop the batch
+    client.pipeline(commands, params_.continueOnError ? params_.depth : 1
+                    , [&](std::size_t index, const CtrlResponse &response
+                          , std::chrono::steady_clock::duration elapsed)
+                    -> bool
+    {
+        ++done;
+        const auto &command(commands[index]);
+        const auto us(std::chrono::duration_cast<std::chrono::microseconds>
+                      (elapsed).count());
+
+        if (response.isError()) {
+            ++failed;
+            err << command << ": error: " << response.error() << '\n';
+        } else {
+            for (const auto &line : response) { os << line << '\n'; }
+        }
+
+        err << "# [" << (index + 1) << "/" << commands.size() << "] "
+            << command << ": " << (response.isError() ? "error" : "ok")
+            << ", " << (us / 1000) << '.' << (us / 100 % 10) << " ms\n";
+
+        os << std::flush;
+        err << std::flush;
+
+        return (params_.continueOnError || !response.isError());
+    });
+
+    if (done < commands.size()) {
+        err << "# stopped on error, " << (commands.size() - done)
+            << " command(s) not executed\n" << std::flush;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+} // namespace service
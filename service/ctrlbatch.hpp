@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_ctrlbatch_hpp_included_
+#define service_ctrlbatch_hpp_included_
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+#include "ctrlclient.hpp"
+
+namespace service {
+
+/** Scripted execution of multiple ctrl commands over single connection.
+ */
+class CtrlBatch {
+public:
+    struct Params {
+        /** Maximum number of commands in flight. Commands sent ahead are
+         *  executed by the server even when an earlier one fails, so depth
+         *  is honoured only together with continueOnError; fail-fast
+         *  batches always run one command at a time.
+         */
+        std::size_t depth = 1;
+
+        /** Do not stop sending commands after first error reply.
+         */
+        bool continueOnError = false;
+    };
+
+    CtrlBatch(const Params &params) : params_(params) {}
+
+    /** Loads commands from stream: one command per line, empty lines and
+     *  lines starting with # are skipped.
+     */
+    static std::vector<std::string> load(std::istream &is);
+
+    /** Runs commands. Replies go to `os`, errors and per-command timing to
+     *  `err`.
+     *
+     *  Returns EXIT_SUCCESS if all commands succeeded, EXIT_FAILURE
+     *  otherwise.
+     */
+    int run(CtrlClientBase &client, const std::vector<std::string> &commands
+            , std::ostream &os, std::ostream &err) const;
+
+private:
+    Params params_;
+};
+
+} // namespace service
+
+#endif // service_ctrlbatch_hpp_included_
@@ -51,10 +51,19 @@ struct CtrlClient::Detail {
                 , name.empty() ? std::string("client") : name)
     {}
 
-    std::vector<std::string> command(const std::string &command) {
-        return ctrl.command(command);
+    CtrlResponse commandResponse(const std::string &command) {
+        return ctrl.commandResponse(command);
     }
 
+    void pipeline(const std::vector<std::string> &commands
+                  , std::size_t depth
+                  , const PipelineCallback &callback)
+    {
+        ctrl.pipeline(commands, depth, callback);
+    }
+
+    bool alive() { return ctrl.alive(); }
+
     detail::CtrlClient<stream_protocol> ctrl;
 };
 
@@ -64,7 +73,85 @@ CtrlClient::CtrlClient(const fs::path &ctrl, const std::string &name)
 
 std::vector<std::string> CtrlClient::command(const std::string &command)
 {
-    return detail().command(command);
+    return detail().commandResponse(command).lines();
+}
+
+CtrlResponse CtrlClient::commandResponse(const std::string &command)
+{
+    return detail().commandResponse(command);
+}
+
+void CtrlClient::pipeline(const std::vector<std::string> &commands
+                          , std::size_t depth
+                          , const PipelineCallback &callback)
+{
+    detail().pipeline(commands, depth, callback);
+}
+
+bool CtrlClient::alive()
+{
+    return detail().alive();
+}
+
+CtrlResponse CtrlClientBase::commandResponse(const std::string &command)
+{
+    std::string buffer;
+    for (const auto &line : this->command(command)) {
+        buffer.append(line);
+        buffer.push_back('\n');
+    }
+    return CtrlResponse(std::move(buffer));
+}
+
+void CtrlClientBase::pipeline(const std::vector<std::string> &commands
+                              , std::size_t depth
+                              , const PipelineCallback &callback)
+{
+    (void) depth;
+
+    typedef std::chrono::steady_clock Clock;
+
+    std::size_t index(0);
+    for (const auto &command : commands) {
+        const auto start(Clock::now());
+        CtrlResponse response;
+        try {
+            response = commandResponse(command);
+        } catch (const utility::CtrlCommandError &e) {
+            response = CtrlResponse(std::string("error: ") + e.what());
+        }
+
+        if (!callback(index++, response, Clock::now() - start)) { break; }
+    }
+}
+
+CtrlResponse::const_iterator CtrlResponse::begin() const
+{
+    if (buffer_.empty()) { return {}; }
+
+    // trailing newline does not start a new line
+    auto size(buffer_.size());
+    if (buffer_.back() == '\n') { --size; }
+    return const_iterator(buffer_.data(), buffer_.data() + size);
+}
+
+bool CtrlResponse::isError() const
+{
+    return front().starts_with("error: ");
+}
+
+CtrlResponse::Line CtrlResponse::error() const
+{
+    return front().substr(7);
+}
+
+std::vector<std::string> CtrlResponse::lines() const
+{
+    std::vector<std::string> lines;
+    for (const auto &line : *this) {
+        lines.emplace_back(line.data(), line.size());
+    }
+    return lines;
 }
 
 bool CtrlClientBase::parseBoolean(const std::string &line) const
@@ -28,16 +28,135 @@
 #define service_ctrl_hpp_included_
 
 #include <string>
+#include <vector>
 #include <memory>
 #include <stdexcept>
+#include <iterator>
+#include <cstring>
+#include <chrono>
+#include <functional>
 
 #include <boost/filesystem/path.hpp>
+#include <boost/utility/string_view.hpp>
 
 #include "utility/streams.hpp"
 #include "utility/ctrlcommand.hpp"
 
 namespace service {
 
+/** Reply to a ctrl command (without the block terminator).
+ *
+ *  Whole reply is kept in one contiguous buffer and lines are exposed as
+ *  views into this buffer, split lazily during iteration. Trailing newline
+ *  does not start a new line. Views are valid while the response exists and
+ *  is not moved from.
+ */
+class CtrlResponse {
+public:
+    typedef boost::string_view Line;
+
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Line value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Line* pointer;
+        typedef Line reference;
+
+        const_iterator() : pos_(), end_(), eol_() {}
+
+        Line operator*() const { return Line(pos_, eol_ - pos_); }
+
+        const_iterator& operator++() {
+            if (eol_ == end_) {
+                pos_ = end_ = eol_ = nullptr;
+            } else {
+                pos_ = eol_ + 1;
+                findEol();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &o) const {
+            return pos_ == o.pos_;
+        }
+
+        bool operator!=(const const_iterator &o) const {
+            return pos_ != o.pos_;
+        }
+
+    private:
+        friend class CtrlResponse;
+
+        const_iterator(const char *pos, const char *end)
+            : pos_(pos), end_(end), eol_()
+        {
+            findEol();
+        }
+
+        void findEol() {
+            eol_ = static_cast<const char*>
+                (std::memchr(pos_, '\n', end_ - pos_));
+            if (!eol_) { eol_ = end_; }
+        }
+
+        const char *pos_;
+        const char *end_;
+        const char *eol_;
+    };
+
+    typedef const_iterator iterator;
+
+    CtrlResponse() = default;
+
+    /** Takes ownership of reply buffer.
+     */
+    explicit CtrlResponse(std::string &&buffer) : buffer_(std::move(buffer)) {}
+
+    const_iterator begin() const;
+    const_iterator end() const { return {}; }
+
+    /** No line at all.
+     */
+    bool empty() const { return buffer_.empty(); }
+
+    /** First line, empty for empty response.
+     */
+    Line front() const { return empty() ? Line() : *begin(); }
+
+    /** Server replied with an error.
+     */
+    bool isError() const;
+
+    /** Error message (valid only if isError() is true).
+     */
+    Line error() const;
+
+    /** Raw reply.
+     */
+    const std::string& buffer() const { return buffer_; }
+
+    /** Lines copied into separate strings (compatibility).
+     */
+    std::vector<std::string> lines() const;
+
+private:
+    std::string buffer_;
+};
+
+/** Request could not be (completely) sent, i.e. it has not been received by
+ *  the server and can be safely re-sent over a new connection.
+ */
+struct CtrlSendError : std::runtime_error {
+    CtrlSendError(const std::string &msg) : std::runtime_error(msg) {}
+};
+
 class CtrlClientBase {
 public:
     virtual ~CtrlClientBase() {}
@@ -46,15 +165,53 @@ public:
 
     virtual Result command(const std::string &command) = 0;
 
+    /** Sends command and returns raw response. Throws
+     *  utility::CtrlCommandError on error reply, as command() does.
+     *
+     *  Default implementation wraps command(); native clients override it to
+     *  avoid splitting response into separate strings.
+     */
+    virtual CtrlResponse commandResponse(const std::string &command);
+
+    /** Called for every reply in pipelined execution, in order. Error
+     *  replies are passed as well (see CtrlResponse::isError()). Elapsed
+     *  time is measured from sending the command.
+     *
+     *  Returning false stops sending further commands.
+     */
+    typedef std::function<bool(std::size_t index
+                               , const CtrlResponse &response
+                               , std::chrono::steady_clock::duration elapsed)>
+        PipelineCallback;
+
+    /** Sends commands over single connection keeping up to `depth` of them
+     *  in flight. When stopped by callback, replies to commands already sent
+     *  are still delivered (and executed by the server).
+     *
+     *  Default implementation executes commands one by one.
+     */
+    virtual void pipeline(const std::vector<std::string> &commands
+                          , std::size_t depth
+                          , const PipelineCallback &callback);
+
     template <typename ...Args>
     std::vector<std::string> command(const std::string &command
                                      , Args &&...args);
 
     bool parseBoolean(const std::string &line) const;
+
+    /** Checks whether underlying connection is still usable (i.e. not closed
+     *  by the server). Used by client pool to validate idle connections.
+     */
+    virtual bool alive() { return true; }
 };
 
 std::unique_ptr<CtrlClientBase> ctrlClientFactory(const std::string &uri);
 
+/** Returns ctrl URI stripped of credentials, suitable for logging.
+ */
+std::string loggableCtrlUri(const std::string &uri);
+
 /** Control socket client.
  *
  *  NB: synchronous version only
@@ -68,6 +225,14 @@ public:
      */
     Result command(const std::string &command) override;
 
+    CtrlResponse commandResponse(const std::string &command) override;
+
+    void pipeline(const std::vector<std::string> &commands
+                  , std::size_t depth
+                  , const PipelineCallback &callback) override;
+
+    bool alive() override;
+
     struct Detail;
 
 private:
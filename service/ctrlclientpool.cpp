@@ -0,0 +1,244 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <map>
+#include <vector>
+#include <mutex>
+
+#include "dbglog/dbglog.hpp"
+
+#include "ctrlclientpool.hpp"
+
+namespace service {
+
+struct CtrlClientPool::Detail {
+    typedef std::unique_ptr<CtrlClientBase> Client;
+    typedef std::vector<Client> ClientList;
+
+    Detail(std::size_t maxIdle) : maxIdle(maxIdle) {}
+
+    Client acquire(const std::string &uri);
+
+    void release(const std::string &uri, Client client);
+
+    Client connect(const std::string &uri, bool reconnect);
+
+    const std::size_t maxIdle;
+
+    mutable std::mutex mutex;
+    std::map<std::string, ClientList> idle;
+    Stats stats;
+};
+
+CtrlClientPool::Detail::Client
+CtrlClientPool::Detail::acquire(const std::string &uri)
+{
+    // closed connections, destroyed outside the lock
+    ClientList dead;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto fidle(idle.find(uri));
+        if (fidle != idle.end()) {
+            auto &clients(fidle->second);
+            while (!clients.empty()) {
+                auto client(std::move(clients.back()));
+                clients.pop_back();
+
+                if (client->alive()) {
+                    ++stats.hits;
+                    return client;
+                }
+
+                // closed by the other side
+                ++stats.stale;
+                dead.push_back(std::move(client));
+            }
+        }
+    }
+
+    return connect(uri, false);
+}
+
+CtrlClientPool::Detail::Client
+CtrlClientPool::Detail::connect(const std::string &uri, bool reconnect)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (reconnect) { ++stats.reconnects; } else { ++stats.misses; }
+    }
+
+    LOG(debug) << "Connecting to control socket <" << loggableCtrlUri(uri) << ">.";
+    return ctrlClientFactory(uri);
+}
+
+void CtrlClientPool::Detail::release(const std::string &uri, Client client)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto &clients(idle[uri]);
+    if (clients.size() >= maxIdle) {
+        // pool is full, drop connection (outside the lock)
+        lock.unlock();
+        client.reset();
+        return;
+    }
+    clients.push_back(std::move(client));
+}
+
+namespace {
+
+class PooledCtrlClient : public CtrlClientBase {
+public:
+    typedef std::shared_ptr<CtrlClientPool::Detail> Pool;
+
+    PooledCtrlClient(const Pool &pool, const std::string &uri)
+        : pool_(pool), uri_(uri), client_(pool_->acquire(uri_))
+    {}
+
+    ~PooledCtrlClient() {
+        if (client_) { pool_->release(uri_, std::move(client_)); }
+    }
+
+    Result command(const std::string &command) override {
+        return call([&](CtrlClientBase &client) {
+                return client.command(command);
+            });
+    }
+
+    CtrlResponse commandResponse(const std::string &command) override {
+        return call([&](CtrlClientBase &client) {
+                return client.commandResponse(command);
+            });
+    }
+
+    /** Not retried: commands might have been already executed.
+     */
+    void pipeline(const std::vector<std::string> &commands
+                  , std::size_t depth
+                  , const PipelineCallback &callback) override;
+
+    bool alive() override { return client_ && client_->alive(); }
+
+private:
+    template <typename Call>
+    auto call(const Call &call)
+        -> decltype(call(std::declval<CtrlClientBase&>()));
+
+    Pool pool_;
+    const std::string uri_;
+    CtrlClientPool::Detail::Client client_;
+};
+
+template <typename Call>
+auto PooledCtrlClient::call(const Call &call)
+    -> decltype(call(std::declval<CtrlClientBase&>()))
+{
+    if (client_) {
+        try {
+            return call(*client_);
+        } catch (const utility::CtrlCommandError&) {
+            // server-side error, connection is still valid
+            throw;
+        } catch (const CtrlSendError &e) {
+            // request has not reached the server, safe to retry
+            LOG(info2)
+                << "Connection to <" << loggableCtrlUri(uri_) << "> lost ("
+                << e.what() << "), reconnecting.";
+        } catch (...) {
+            // failed after the request was sent: command might have been
+            // executed, must not be repeated
+            client_.reset();
+            throw;
+        }
+    }
+
+    // (re)connect and retry exactly once; connection is dropped on failure
+    client_.reset();
+    client_ = pool_->connect(uri_, true);
+    try {
+        return call(*client_);
+    } catch (const utility::CtrlCommandError&) {
+        throw;
+    } catch (...) {
+        client_.reset();
+        throw;
+    }
+}
+
+void PooledCtrlClient::pipeline(const std::vector<std::string> &commands
+                                , std::size_t depth
+                                , const PipelineCallback &callback)
+{
+    if (!client_ || !client_->alive()) {
+        client_.reset();
+        client_ = pool_->connect(uri_, true);
+    }
+
+    try {
+        client_->pipeline(commands, depth, callback);
+    } catch (...) {
+        client_.reset();
+        throw;
+    }
+}
+
+} // namespace
+
+CtrlClientPool::CtrlClientPool(std::size_t maxIdle)
+    : detail_(std::make_shared<Detail>(maxIdle))
+{}
+
+CtrlClientPool::~CtrlClientPool() {}
+
+std::unique_ptr<CtrlClientBase> CtrlClientPool::get(const std::string &uri)
+{
+    return std::unique_ptr<CtrlClientBase>
+        (new PooledCtrlClient(detail_, uri));
+}
+
+CtrlClientPool::Stats CtrlClientPool::stats() const
+{
+    std::unique_lock<std::mutex> lock(detail_->mutex);
+    return detail_->stats;
+}
+
+void CtrlClientPool::clear()
+{
+    decltype(detail_->idle) idle;
+    {
+        std::unique_lock<std::mutex> lock(detail_->mutex);
+        std::swap(idle, detail_->idle);
+    }
+    // connections closed here, outside the lock
+}
+
+std::unique_ptr<CtrlClientBase> ctrlClientFactory(const std::string &uri
+                                                  , CtrlClientPool &pool)
+{
+    return pool.get(uri);
+}
+
+} // namespace service
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_ctrlclientpool_hpp_included_
+#define service_ctrlclientpool_hpp_included_
+
+#include <cstdint>
+#include <string>
+#include <memory>
+
+#include "ctrlclient.hpp"
+
+namespace service {
+
+/** Pool of control clients keyed by URI (see ctrlClientFactory).
+ *
+ *  Idle connections are kept alive and validated before reuse; connection
+ *  (and network handshake) is established only when there is no usable idle
+ *  connection. Client obtained from the pool transparently reconnects (once)
+ *  when the command cannot be sent because the connection is lost, e.g.
+ *  after server restart. Failures after the command has been sent are
+ *  reported to the caller since the command might have been executed.
+ *
+ *  Pool is thread safe, obtained clients are not.
+ */
+class CtrlClientPool {
+public:
+    struct Stats {
+        /** Idle connection reused.
+         */
+        std::uint64_t hits = 0;
+
+        /** New connection had to be established.
+         */
+        std::uint64_t misses = 0;
+
+        /** Idle connection found closed and dropped.
+         */
+        std::uint64_t stale = 0;
+
+        /** Connection re-established after failure during command.
+         */
+        std::uint64_t reconnects = 0;
+    };
+
+    /** Creates new pool.
+     *
+     * \param maxIdle maximum number of idle connections kept per URI
+     */
+    CtrlClientPool(std::size_t maxIdle = 4);
+
+    ~CtrlClientPool();
+
+    /** Returns client connected to given URI. Connection is returned to the
+     *  pool when returned client is destroyed.
+     */
+    std::unique_ptr<CtrlClientBase> get(const std::string &uri);
+
+    /** Returns snapshot of pool statistics.
+     */
+    Stats stats() const;
+
+    /** Drops all idle connections.
+     */
+    void clear();
+
+    struct Detail;
+
+private:
+    std::shared_ptr<Detail> detail_;
+};
+
+/** Pooled version of ctrlClientFactory(uri).
+ */
+std::unique_ptr<CtrlClientBase> ctrlClientFactory(const std::string &uri
+                                                  , CtrlClientPool &pool);
+
+} // namespace service
+
+#endif // service_ctrlclientpool_hpp_included_
@@ -24,7 +24,19 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <random>
+#include <stdexcept>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include "dbglog/dbglog.hpp"
 
 #include "utility/md5.hpp"
 
@@ -34,27 +46,95 @@ namespace service {
 
 namespace {
 
-std::random_device rng;
+const std::string HmacPrefix("hmac-sha256 ");
+const std::string SessionPrefix("session ");
+const std::string ResumePrefix("resume ");
+const std::string Resumed("resumed");
 
-const std::string alphabet("abcdefghijklmnopqrstuvwxyz"
-                           "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                           "1234567890"
-                           "!@#$%^&*()"
-                           "`~-_=+[{]}\\|;:'\",<.>/? ");
+std::string hex(const std::string &data)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(data.size() * 2);
+    for (unsigned char c : data) {
+        out.push_back(digits[c >> 4]);
+        out.push_back(digits[c & 0x0f]);
+    }
+    return out;
+}
 
-} // namespace
+std::string randomHex(std::size_t bytes)
+{
+    std::string out(bytes, '\0');
+    if (1 != ::RAND_bytes(reinterpret_cast<unsigned char*>(&out[0])
+                          , int(bytes)))
+    {
+        LOGTHROW(err2, std::runtime_error)
+            << "Cannot generate random bytes.";
+    }
+    return hex(out);
+}
 
-std::string ctrlChallenge()
+/** Comparison that does not leak position of first difference.
+ */
+bool constantTimeEqual(const std::string &a, const std::string &b)
 {
-    std::uniform_int_distribution<> index(0, alphabet.size() - 1);
+    if (a.size() != b.size()) { return false; }
+    unsigned char diff(0);
+    for (std::size_t i(0); i < a.size(); ++i) { diff |= (a[i] ^ b[i]); }
+    return !diff;
+}
 
-    std::string out;
+/** Process-wide cache of sessions issued to this client.
+ */
+class SessionCache {
+public:
+    static SessionCache& instance() {
+        static SessionCache cache;
+        return cache;
+    }
 
-    for (int i = 0; i < 32; ++i) {
-        out.push_back(alphabet[index(rng)]);
+    struct Session {
+        std::string id;
+        std::string key;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    boost::optional<Session> get(const std::string &key) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto fsessions(sessions_.find(key));
+        if (fsessions == sessions_.end()) { return boost::none; }
+        if (fsessions->second.expires <= std::chrono::steady_clock::now()) {
+            sessions_.erase(fsessions);
+            return boost::none;
+        }
+        return fsessions->second;
     }
 
-    return out;
+    void put(const std::string &key, const std::string &id
+             , const std::string &sessionKey, std::chrono::seconds ttl)
+    {
+        // expire a bit sooner to avoid racing server-side expiration
+        std::lock_guard<std::mutex> guard(mutex_);
+        sessions_[key] = { id, sessionKey, (std::chrono::steady_clock::now()
+                                            + ttl - ttl / 10) };
+    }
+
+    bool drop(const std::string &key) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return sessions_.erase(key);
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<std::string, Session> sessions_;
+};
+
+} // namespace
+
+std::string ctrlChallenge()
+{
+    return randomHex(16);
 }
 
 std::string ctrlResponse(const std::string &challenge
@@ -63,4 +143,312 @@ std::string ctrlResponse(const std::string &challenge
     return utility::md5::hash_hex(challenge + ":" + secret);
 }
 
+std::string hmacSha256Hex(const std::string &key, const std::string &message)
+{
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int size(0);
+    if (!::HMAC(::EVP_sha256(), key.data(), int(key.size())
+                , reinterpret_cast<const unsigned char*>(message.data())
+                , message.size(), md, &size))
+    {
+        LOGTHROW(err2, std::runtime_error)
+            << "HMAC-SHA256 computation failed.";
+    }
+    return hex(std::string(reinterpret_cast<const char*>(md), size));
+}
+
+std::string ctrlHmacResponse(const std::string &challenge
+                             , const std::string &component
+                             , const std::string &secret)
+{
+    return hmacSha256Hex(secret, challenge + ":" + component);
+}
+
+std::string ctrlSessionKey(const std::string &secret
+                           , const std::string &component
+                           , const std::string &sessionId)
+{
+    return hmacSha256Hex(secret, "session:" + component + ":" + sessionId);
+}
+
+std::string ctrlResumeProof(const std::string &sessionKey
+                            , const std::string &component
+                            , const std::string &sessionId
+                            , const std::string &nonce
+                            , const std::string &timestamp)
+{
+    return hmacSha256Hex(sessionKey, "resume:" + component + ":" + sessionId
+                         + ":" + nonce + ":" + timestamp);
+}
+
+CtrlSessionTokens::CtrlSessionTokens(std::chrono::seconds ttl
+                                     , const std::string &key
+                                     , std::chrono::seconds replayWindow)
+    : ttl_(ttl), key_(key.empty() ? randomHex(32) : key)
+    , replayWindow_(replayWindow)
+{}
+
+std::string CtrlSessionTokens::mac(const std::string &component
+                                   , const std::string &expiry
+                                   , const std::string &nonce) const
+{
+    return hmacSha256Hex(key_, component + "." + expiry + "." + nonce);
+}
+
+std::string CtrlSessionTokens::issue(const std::string &component) const
+{
+    const auto expiry(boost::lexical_cast<std::string>
+                      (std::chrono::duration_cast<std::chrono::seconds>
+                       ((std::chrono::system_clock::now() + ttl_)
+                        .time_since_epoch()).count()));
+    const auto nonce(randomHex(8));
+    return expiry + "." + nonce + "." + mac(component, expiry, nonce);
+}
+
+bool CtrlSessionTokens::verify(const std::string &component
+                               , const std::string &id) const
+{
+    const auto dot1(id.find('.'));
+    if (dot1 == std::string::npos) { return false; }
+    const auto dot2(id.find('.', dot1 + 1));
+    if (dot2 == std::string::npos) { return false; }
+
+    const auto expiry(id.substr(0, dot1));
+    const auto nonce(id.substr(dot1 + 1, dot2 - dot1 - 1));
+
+    if (!constantTimeEqual(id.substr(dot2 + 1)
+                           , mac(component, expiry, nonce)))
+    {
+        return false;
+    }
+
+    // MAC is valid -> expiry is our own number
+    const auto now(std::chrono::duration_cast<std::chrono::seconds>
+                   (std::chrono::system_clock::now().time_since_epoch())
+                   .count());
+    try {
+        return now < boost::lexical_cast<long long>(expiry);
+    } catch (const boost::bad_lexical_cast&) {}
+    return false;
+}
+
+bool CtrlSessionTokens::fresh(const std::string &nonce
+                              , const std::string &timestamp) const
+{
+    long long ts(0);
+    try {
+        ts = boost::lexical_cast<long long>(timestamp);
+    } catch (const boost::bad_lexical_cast&) {
+        return false;
+    }
+
+    const auto now(std::chrono::duration_cast<std::chrono::seconds>
+                   (std::chrono::system_clock::now().time_since_epoch())
+                   .count());
+    const auto window(replayWindow_.count());
+    if ((ts < now - window) || (ts > now + window)) { return false; }
+
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    // forget nonces that cannot be replayed anymore
+    for (auto iseen(seen_.begin()); iseen != seen_.end(); ) {
+        if (iseen->second < now - window) {
+            iseen = seen_.erase(iseen);
+        } else {
+            ++iseen;
+        }
+    }
+
+    return seen_.insert(std::make_pair(nonce, ts)).second;
+}
+
+bool CtrlServerHandshake::resume(const std::vector<std::string> &words)
+{
+    // resume <session id> <nonce> <timestamp> <proof>
+    if (!tokens_ || (words.size() != 5) || (words[0] != "resume")) {
+        return false;
+    }
+
+    const auto &id(words[1]);
+    if (!tokens_->verify(component_, id)) {
+        LOG(info1) << "Component <" << component_
+                   << ">: unknown or expired session.";
+        return false;
+    }
+
+    const auto key(ctrlSessionKey(secret_, component_, id));
+    if (!constantTimeEqual(words[4], ctrlResumeProof(key, component_, id
+                                                     , words[2], words[3])))
+    {
+        LOG(warn2) << "Component <" << component_
+                   << ">: invalid session resumption proof.";
+        return false;
+    }
+
+    if (!tokens_->fresh(words[2], words[3])) {
+        LOG(warn2) << "Component <" << component_
+                   << ">: stale or replayed session resumption.";
+        return false;
+    }
+
+    return true;
+}
+
+std::string CtrlServerHandshake::process(const std::string &line)
+{
+    switch (state_) {
+    case State::initial: {
+        std::vector<std::string> words;
+        for (std::size_t start(0); start <= line.size(); ) {
+            auto end(line.find(' ', start));
+            if (end == std::string::npos) { end = line.size(); }
+            words.push_back(line.substr(start, end - start));
+            start = end + 1;
+        }
+        component_ = words.front();
+
+        const auto secret(lookup_(component_));
+        if (!secret) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Unknown component <" << component_ << ">.";
+        }
+        secret_ = *secret;
+
+        words.erase(words.begin());
+        if (resume(words)) {
+            LOG(info1) << "Component <" << component_
+                       << ">: session resumed.";
+            state_ = State::done;
+            return Resumed;
+        }
+
+        challenge_ = HmacPrefix + ctrlChallenge();
+        state_ = State::challenged;
+        return challenge_;
+    }
+
+    case State::challenged:
+        if (constantTimeEqual
+            (line, ctrlHmacResponse(challenge_.substr(HmacPrefix.size())
+                                    , component_, secret_)))
+        {
+            state_ = State::done;
+            if (!tokens_) { return {}; }
+            return SessionPrefix + tokens_->issue(component_) + " "
+                + boost::lexical_cast<std::string>(tokens_->ttl().count());
+        }
+
+        if (allowLegacy_
+            && constantTimeEqual(line, ctrlResponse(challenge_, secret_)))
+        {
+            LOG(warn2) << "Component <" << component_
+                       << ">: authenticated via legacy md5 response.";
+            state_ = State::done;
+            return {};
+        }
+
+        LOGTHROW(err2, std::runtime_error)
+            << "Component <" << component_ << ">: authentication failed.";
+        break;
+
+    case State::done:
+        LOGTHROW(err2, std::logic_error)
+            << "Handshake already finished.";
+        break;
+    }
+
+    return {};
+}
+
+std::string CtrlClientHandshake::start()
+{
+    state_ = State::hello;
+    if (!cacheKey_.empty()) {
+        if (auto session = SessionCache::instance().get(cacheKey_)) {
+            // only the id is sent, key is used to sign the request
+            tokenSent_ = true;
+            const auto nonce(randomHex(16));
+            const auto timestamp(boost::lexical_cast<std::string>
+                                 (std::chrono::duration_cast
+                                  <std::chrono::seconds>
+                                  (std::chrono::system_clock::now()
+                                   .time_since_epoch()).count()));
+            return component_ + " " + ResumePrefix + session->id + " "
+                + nonce + " " + timestamp + " "
+                + ctrlResumeProof(session->key, component_, session->id
+                                  , nonce, timestamp);
+        }
+    }
+    return component_;
+}
+
+boost::optional<std::string>
+CtrlClientHandshake::next(const std::vector<std::string> &reply)
+{
+    switch (state_) {
+    case State::hello: {
+        if (reply.empty()) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Server sent no challenge.";
+        }
+
+        const auto &line(reply.front());
+        if (tokenSent_ && (line == Resumed)) {
+            resumed_ = true;
+            state_ = State::done;
+            return boost::none;
+        }
+
+        // session (if any) not accepted
+        if (tokenSent_) { failed(); }
+
+        state_ = State::challenged;
+        if (line.compare(0, HmacPrefix.size(), HmacPrefix)) {
+            // legacy server
+            LOG(warn2) << "Server does not support HMAC handshake, "
+                       << "answering with legacy md5 response.";
+            return ctrlResponse(line, secret_);
+        }
+
+        return ctrlHmacResponse(line.substr(HmacPrefix.size())
+                                , component_, secret_);
+    }
+
+    case State::challenged:
+        state_ = State::done;
+        if (cacheKey_.empty()) { break; }
+
+        for (const auto &line : reply) {
+            if (line.compare(0, SessionPrefix.size(), SessionPrefix)) {
+                continue;
+            }
+
+            // session <id> <ttl>
+            const auto rest(line.substr(SessionPrefix.size()));
+            const auto space(rest.find(' '));
+            if (space == std::string::npos) { continue; }
+            try {
+                const auto id(rest.substr(0, space));
+                SessionCache::instance().put
+                    (cacheKey_, id, ctrlSessionKey(secret_, component_, id)
+                     , std::chrono::seconds
+                     (boost::lexical_cast<long>(rest.substr(space + 1))));
+            } catch (const boost::bad_lexical_cast&) {}
+        }
+        break;
+
+    case State::initial:
+    case State::done:
+        break;
+    }
+
+    return boost::none;
+}
+
+bool CtrlClientHandshake::failed()
+{
+    if (cacheKey_.empty()) { return false; }
+    return SessionCache::instance().drop(cacheKey_);
+}
+
 } // namespace service
@@ -28,14 +28,212 @@
 #define service_ctrlhandshake_hpp_included_
 
 #include <string>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <map>
+#include <mutex>
+
+#include <boost/optional.hpp>
 
 namespace service {
 
+/** Random challenge (32 hex digits from RAND_bytes). Throws
+ *  std::runtime_error when no randomness is available.
+ */
 std::string ctrlChallenge();
 
+/** Legacy challenge response: md5(challenge:secret).
+ */
 std::string ctrlResponse(const std::string &challenge
                          , const std::string &secret);
 
+/** HMAC-SHA256 of message keyed by key, hex encoded.
+ */
+std::string hmacSha256Hex(const std::string &key, const std::string &message);
+
+/** HMAC challenge response: hmac-sha256(secret, challenge:component).
+ */
+std::string ctrlHmacResponse(const std::string &challenge
+                             , const std::string &component
+                             , const std::string &secret);
+
+/** Session key derived from component's secret and session id:
+ *  hmac-sha256(secret, session:component:id). Both sides derive it on their
+ *  own, it is never sent.
+ */
+std::string ctrlSessionKey(const std::string &secret
+                           , const std::string &component
+                           , const std::string &sessionId);
+
+/** Session resumption proof: hmac-sha256(session key,
+ *  resume:component:id:nonce:timestamp).
+ */
+std::string ctrlResumeProof(const std::string &sessionKey
+                            , const std::string &component
+                            , const std::string &sessionId
+                            , const std::string &nonce
+                            , const std::string &timestamp);
+
+/** Network ctrl handshake protocol (one line per message):
+ *
+ *  client: <component>[ resume <session id> <nonce> <timestamp> <proof>]
+ *  server: resumed                           (valid resumption, done)
+ *        | hmac-sha256 <challenge>           (HMAC capable server)
+ *        | <challenge>                       (legacy server)
+ *  client: <response>                        (HMAC or legacy md5 response)
+ *  server: session <id> <ttl in seconds>     (optional, after HMAC response)
+ *
+ *  Resumption takes a single round trip: client proves it holds the session
+ *  key (never sent) by MAC over session id, its own random nonce and current
+ *  time (seconds since epoch). Server accepts the proof only within a replay
+ *  window around its own time and only once per nonce. Any failed
+ *  resumption falls back to the full challenge on the same connection.
+ *
+ *  Session id is sent only to a server that issued one before therefore
+ *  legacy servers never see it. Legacy clients talk to HMAC server by
+ *  answering the whole challenge line with md5 response; server accepts it
+ *  only when explicitly allowed.
+ */
+
+/** Server-issued session ids. Id is "expiry.nonce.mac" where mac is HMAC of
+ *  component, expiry and nonce keyed by server-side key. Ids are therefore
+ *  stateless and cannot be forged without the key. Id is not a credential by
+ *  itself (see ctrlSessionKey()).
+ *
+ *  Also keeps resumption nonces seen within the replay window. Thread safe.
+ */
+class CtrlSessionTokens {
+public:
+    /** Uses random key if none given, i.e. sessions do not survive restart.
+     */
+    CtrlSessionTokens(std::chrono::seconds ttl
+                      , const std::string &key = std::string()
+                      , std::chrono::seconds replayWindow
+                      = std::chrono::seconds(30));
+
+    std::string issue(const std::string &component) const;
+
+    /** Checks that id has been issued for given component and has not
+     *  expired yet.
+     */
+    bool verify(const std::string &component, const std::string &id)
+        const;
+
+    /** Checks resumption timestamp (seconds since epoch) is within replay
+     *  window from now and records the nonce; returns false for stale
+     *  timestamp or nonce already seen. Call only for verified proofs.
+     */
+    bool fresh(const std::string &nonce, const std::string &timestamp)
+        const;
+
+    std::chrono::seconds ttl() const { return ttl_; }
+
+private:
+    std::string mac(const std::string &component, const std::string &expiry
+                    , const std::string &nonce) const;
+
+    std::chrono::seconds ttl_;
+    std::string key_;
+    std::chrono::seconds replayWindow_;
+
+    mutable std::mutex mutex_;
+    /** Seen nonce -> its timestamp.
+     */
+    mutable std::map<std::string, long long> seen_;
+};
+
+/** Server side of the network ctrl handshake.
+ *
+ *  process(line) returns reply to send back to the client (without block
+ *  terminator); throws std::runtime_error when authentication fails.
+ */
+class CtrlServerHandshake {
+public:
+    /** Returns secret for given component, none for unknown component.
+     */
+    typedef std::function<boost::optional<std::string>
+                          (const std::string &component)> SecretLookup;
+
+    /** Legacy md5 response is accepted only if allowLegacy is true;
+     *  otherwise a client could be forced back to it by anyone in the
+     *  middle. Each legacy login is logged.
+     */
+    CtrlServerHandshake(const SecretLookup &lookup
+                        , const CtrlSessionTokens *tokens = nullptr
+                        , bool allowLegacy = false)
+        : lookup_(lookup), tokens_(tokens), allowLegacy_(allowLegacy)
+        , state_(State::initial)
+    {}
+
+    std::string process(const std::string &line);
+
+    bool authenticated() const { return state_ == State::done; }
+
+    const std::string& component() const { return component_; }
+
+private:
+    enum class State { initial, challenged, done };
+
+    /** Validates resumption request (words after component), returns true
+     *  if it can be accepted.
+     */
+    bool resume(const std::vector<std::string> &words);
+
+    SecretLookup lookup_;
+    const CtrlSessionTokens *tokens_;
+    bool allowLegacy_;
+    State state_;
+    std::string component_;
+    std::string secret_;
+    std::string challenge_;
+};
+
+/** Client side of the network ctrl handshake expressed as a line-based state
+ *  machine so that it can be driven both synchronously and asynchronously.
+ *
+ *  start() returns first line to send, next(reply) returns next line to send
+ *  or none when handshake is complete.
+ *
+ *  Non-empty peer (e.g. server endpoint) enables session resumption: issued
+ *  session ids (with derived session keys) are kept in process-wide cache
+ *  keyed by peer and component. Failed handshake must be reported via
+ *  failed() to drop cached session.
+ */
+class CtrlClientHandshake {
+public:
+    CtrlClientHandshake(const std::string &component
+                        , const std::string &secret
+                        , const std::string &peer = std::string())
+        : component_(component), secret_(secret)
+        , cacheKey_(peer.empty() ? peer : peer + "/" + component)
+        , state_(State::initial), tokenSent_(false), resumed_(false)
+    {}
+
+    std::string start();
+
+    boost::optional<std::string> next(const std::vector<std::string> &reply);
+
+    /** Drops cached session for this peer. Returns true if there was one,
+     *  i.e. retry with full handshake makes sense.
+     */
+    bool failed();
+
+    /** Handshake done via session resumption.
+     */
+    bool resumed() const { return resumed_; }
+
+private:
+    enum class State { initial, hello, challenged, done };
+
+    std::string component_;
+    std::string secret_;
+    std::string cacheKey_;
+    State state_;
+    bool tokenSent_;
+    bool resumed_;
+};
+
 } // namespace service
 
 #endif // service_ctrlhandshake_hpp_included_
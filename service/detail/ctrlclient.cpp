@@ -32,6 +32,7 @@
 #include "dbglog/dbglog.hpp"
 
 #include "utility/cppversion.hpp"
+#include "utility/uri.hpp"
 
 #include "../ctrlclient.hpp"
 #include "../netctrlclient.hpp"
@@ -52,4 +53,12 @@ std::unique_ptr<CtrlClientBase> ctrlClientFactory(const std::string &uri)
     return std::make_unique<CtrlClient>(uri);
 }
 
+std::string loggableCtrlUri(const std::string &uri)
+{
+    if (!ba::istarts_with(uri, "ctrl:")) { return uri; }
+    utility::Uri u(uri);
+    u.dropAuthInfo(true);
+    return u.str();
+}
+
 } // namespace service
@@ -31,10 +31,10 @@
 #include <memory>
 #include <stdexcept>
 
+#include <poll.h>
+
 #include <boost/asio.hpp>
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/classification.hpp>
-#include <boost/algorithm/string/predicate.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include "dbglog/dbglog.hpp"
 
@@ -42,6 +42,8 @@
 #include "utility/ctrlcommand.hpp"
 #include "utility/raise.hpp"
 
+#include "../ctrlclient.hpp"
+
 namespace service { namespace detail {
 
 template <typename Protocol>
@@ -64,7 +66,33 @@ struct CtrlClient {
         }
     }
 
-    std::vector<std::string> command(const std::string &command);
+    std::vector<std::string> command(const std::string &command) {
+        return commandResponse(command).lines();
+    }
+
+    /** Sends command and receives response. Raises utility::CtrlCommandError
+     *  on error reply.
+     */
+    CtrlResponse commandResponse(const std::string &command);
+
+    /** Sends command without waiting for reply. Throws CtrlSendError when
+     *  the command cannot be written.
+     */
+    void send(const std::string &command);
+
+    /** Receives next reply. Error replies are not raised.
+     */
+    CtrlResponse receive();
+
+    void pipeline(const std::vector<std::string> &commands
+                  , std::size_t depth
+                  , const CtrlClientBase::PipelineCallback &callback);
+
+    /** Checks whether connection is still usable. Server never talks unless
+     *  asked to, therefore any readable data (or EOF) means the connection
+     *  has been closed or is out of sync.
+     */
+    bool alive();
 
     const std::string endpointStr;
     const Endpoint endpoint;
@@ -72,40 +100,133 @@ struct CtrlClient {
 
     boost::asio::io_service ios;
     Socket socket;
-    boost::asio::streambuf responseBuffer;
+
+    /** Data read past the end of the last response.
+     */
+    std::string pending;
 };
 
+/** Session cache key (see CtrlClientHandshake) of network ctrl server:
+ *  its resolved address and port. Shared by all network clients so that a
+ *  session obtained by one of them can be resumed by another.
+ */
+inline std::string ctrlSessionPeer(const boost::asio::ip::tcp::endpoint
+                                   &endpoint)
+{
+    return boost::lexical_cast<std::string>(endpoint);
+}
+
+/** Raises utility::CtrlCommandError if server replied with an error.
+ */
+inline void checkResponse(const std::string &name
+                          , const CtrlResponse &response)
+{
+    if (response.isError()) {
+        utility::raise<utility::CtrlCommandError>
+            ("%s: %s", name, response.error().to_string());
+    }
+}
+
+/** Splits response block (without terminator) into lines. Raises
+ *  utility::CtrlCommandError if server replied with an error.
+ */
+inline std::vector<std::string> parseResponse(const std::string &name
+                                              , std::string response)
+{
+    CtrlResponse r(std::move(response));
+    checkResponse(name, r);
+    return r.lines();
+}
+
 template <typename Protocol>
-std::vector<std::string>
-CtrlClient<Protocol>::command(const std::string &command)
+void CtrlClient<Protocol>::send(const std::string &command)
 {
     // command + newline
     std::vector<boost::asio::const_buffer> request;
     request.emplace_back(command.data(), command.size());
     request.emplace_back("\n", 1);
 
-    boost::asio::write(socket, request);
-
-    boost::asio::read_until(socket, responseBuffer, "\4");
+    try {
+        boost::asio::write(socket, request);
+    } catch (const boost::system::system_error &e) {
+        throw CtrlSendError(endpointStr + ": cannot send command: "
+                            + e.what());
+    }
+}
 
-    std::istream is(&responseBuffer);
+template <typename Protocol>
+CtrlResponse CtrlClient<Protocol>::receive()
+{
+    // read directly into the response buffer, no intermediate copies
+    auto size(boost::asio::read_until
+              (socket, boost::asio::dynamic_buffer(pending), '\4'));
 
     std::string response;
-    std::getline(is, response, '\4');
+    if (size == pending.size()) {
+        // the usual case: nothing past the terminator, steal the buffer
+        response.swap(pending);
+        response.pop_back();
+    } else {
+        response.assign(pending, 0, size - 1);
+        pending.erase(0, size);
+    }
+
+    return CtrlResponse(std::move(response));
+}
 
-    std::vector<std::string> lines;
-    boost::algorithm::split(lines, response
-                            , boost::algorithm::is_any_of("\n"));
+template <typename Protocol>
+CtrlResponse CtrlClient<Protocol>::commandResponse(const std::string &command)
+{
+    send(command);
+    auto r(receive());
+    checkResponse(name, r);
+    return r;
+}
 
-    if (!lines.empty()) {
-        if (boost::algorithm::starts_with(lines.front(), "error: ")) {
-            utility::raise<utility::CtrlCommandError>
-                ("%s: %s", name, lines.front().substr(7));
+template <typename Protocol>
+void CtrlClient<Protocol>::pipeline
+(const std::vector<std::string> &commands, std::size_t depth
+ , const CtrlClientBase::PipelineCallback &callback)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    depth = std::max<std::size_t>(depth, 1);
+    std::vector<Clock::time_point> sentAt(commands.size());
+
+    std::size_t sent(0);
+    std::size_t received(0);
+    bool stop(false);
+
+    for (;;) {
+        while (!stop && (sent < commands.size())
+               && ((sent - received) < depth))
+        {
+            sentAt[sent] = Clock::now();
+            send(commands[sent++]);
+        }
+
+        if (received == sent) { break; }
+
+        const auto r(receive());
+        const auto index(received++);
+        if (!callback(index, r, Clock::now() - sentAt[index])) {
+            stop = true;
         }
-        if (lines.back().empty()) { lines.pop_back(); }
     }
+}
+
+template <typename Protocol>
+bool CtrlClient<Protocol>::alive()
+{
+    if (!socket.is_open() || !pending.empty()) { return false; }
+
+    ::pollfd pfd;
+    pfd.fd = socket.native_handle();
+    pfd.events = POLLIN;
+    pfd.revents = 0;
 
-    return lines;
+    // non-blocking check
+    return !::poll(&pfd, 1, 0);
 }
 
 } } // namespace service::detail
@@ -0,0 +1,316 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <system_error>
+
+// NB: __GLIBC__ is defined by any C library header included above
+#ifdef __GLIBC__
+#  include <malloc.h>
+#endif
+#ifdef __linux__
+#  include <sys/prctl.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "utility/raise.hpp"
+#include "utility/ctrlcommand.hpp"
+
+#include "malloc.hpp"
+#include "procfs.hpp"
+
+namespace ba = boost::algorithm;
+
+namespace service { namespace detail {
+
+namespace {
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) \
+                           || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+#  define SERVICE_HAS_MALLINFO2 1
+#endif
+
+void setOption(dbglog::module &log, const char *name, int param
+               , const boost::optional<int> &value)
+{
+    if (!value) { return; }
+#ifdef __GLIBC__
+    LOG(info3, log) << "Setting malloc " << name << " to " << *value << ".";
+    if (!::mallopt(param, *value)) {
+        LOG(warn3, log) << "Failed to set malloc " << name << " to "
+                        << *value << ".";
+    }
+#else
+    (void) param;
+    LOG(warn3, log) << "Cannot set malloc " << name
+                    << ": not supported by this C library.";
+#endif
+}
+
+std::string thpStatus()
+{
+#ifdef PR_GET_THP_DISABLE
+    const auto r(::prctl(PR_GET_THP_DISABLE, 0, 0, 0, 0));
+    if (r < 0) { return "?"; }
+    if (!r) { return "enabled (system policy)"; }
+#  ifdef PR_THP_DISABLE_EXCEPT_ADVISED
+    if (r & PR_THP_DISABLE_EXCEPT_ADVISED) { return "madvise"; }
+#  endif
+    return "never";
+#else
+    return "?";
+#endif
+}
+
+template <typename T>
+void printOptional(std::ostream &os, const char *name
+                   , const boost::optional<T> &value)
+{
+    os << name << ": ";
+    if (value) { os << *value; } else { os << "default"; }
+    os << '\n';
+}
+
+/** Returns malloc_info(3) XML, empty if not available.
+ */
+std::string mallocInfo()
+{
+#ifdef __GLIBC__
+    char *buf(nullptr);
+    std::size_t size(0);
+    auto f(::open_memstream(&buf, &size));
+    if (!f) { return {}; }
+    ::malloc_info(0, f);
+    std::fclose(f);
+    std::string out(buf, size);
+    std::free(buf);
+    return out;
+#else
+    return {};
+#endif
+}
+
+/** Extracts integer attribute value from XML element line.
+ */
+std::string attribute(const std::string &line, const std::string &name)
+{
+    const auto key(name + "=\"");
+    auto start(line.find(key));
+    if (start == std::string::npos) { return {}; }
+    start += key.size();
+    return line.substr(start, line.find('"', start) - start);
+}
+
+/** Summarizes malloc_info output: number of heaps and process totals.
+ */
+void mallocSummary(std::ostream &os)
+{
+    const auto xml(mallocInfo());
+    if (xml.empty()) {
+        os << "malloc_info: unavailable\n";
+        return;
+    }
+
+    std::size_t heaps(0);
+    bool inHeap(false);
+
+    std::istringstream is(xml);
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.find("<heap ") != std::string::npos) {
+            ++heaps;
+            inHeap = true;
+        } else if (line.find("</heap>") != std::string::npos) {
+            inHeap = false;
+        } else if (!inHeap) {
+            // process-wide totals
+            if (line.find("<total ") != std::string::npos) {
+                os << "total." << attribute(line, "type") << ": count "
+                   << attribute(line, "count") << ", size "
+                   << attribute(line, "size") << '\n';
+            } else if ((line.find("<system ") != std::string::npos)
+                       || (line.find("<aspace ") != std::string::npos))
+            {
+                os << ((line.find("<system ") != std::string::npos)
+                       ? "system." : "aspace.")
+                   << attribute(line, "type") << ": "
+                   << attribute(line, "size") << '\n';
+            }
+        }
+    }
+
+    os << "heaps: " << heaps << '\n';
+}
+
+} // namespace
+
+void MallocConfig::configuration(po::options_description &cmdline
+                                 , po::options_description &config)
+{
+    (void) cmdline;
+    config.add_options()
+        ("service.malloc.arenaMax", po::value<int>()
+         , "Maximum number of malloc arenas (mallopt M_ARENA_MAX).")
+        ("service.malloc.trimThreshold", po::value<int>()
+         , "Free memory at heap top to trigger trim "
+         "(mallopt M_TRIM_THRESHOLD).")
+        ("service.malloc.mmapThreshold", po::value<int>()
+         , "Allocation size served directly by mmap "
+         "(mallopt M_MMAP_THRESHOLD).")
+        ("service.thp", po::value(&thp)
+         , "Transparent huge pages for this process: always, madvise "
+         "or never.")
+        ;
+}
+
+void MallocConfig::configure(const po::variables_map &vars)
+{
+    const auto get([&](const char *name, boost::optional<int> &value)
+    {
+        if (vars.count(name)) { value = vars[name].as<int>(); }
+    });
+
+    get("service.malloc.arenaMax", arenaMax);
+    get("service.malloc.trimThreshold", trimThreshold);
+    get("service.malloc.mmapThreshold", mmapThreshold);
+
+    if (!thp.empty() && (thp != "always") && (thp != "madvise")
+        && (thp != "never"))
+    {
+        throw po::error("Invalid value <" + thp + "> of service.thp.");
+    }
+}
+
+void MallocConfig::apply(dbglog::module &log) const
+{
+#ifdef __GLIBC__
+    setOption(log, "arenaMax", M_ARENA_MAX, arenaMax);
+    setOption(log, "trimThreshold", M_TRIM_THRESHOLD, trimThreshold);
+    setOption(log, "mmapThreshold", M_MMAP_THRESHOLD, mmapThreshold);
+#else
+    setOption(log, "arenaMax", 0, arenaMax);
+    setOption(log, "trimThreshold", 0, trimThreshold);
+    setOption(log, "mmapThreshold", 0, mmapThreshold);
+#endif
+
+    if (thp.empty()) { return; }
+
+#ifdef PR_SET_THP_DISABLE
+    // THP can only be disabled per process; "always" means follow system
+    // policy
+    unsigned long disable(0);
+    unsigned long flags(0);
+    if (thp == "never") {
+        disable = 1;
+    } else if (thp == "madvise") {
+#  ifdef PR_THP_DISABLE_EXCEPT_ADVISED
+        disable = 1;
+        flags = PR_THP_DISABLE_EXCEPT_ADVISED;
+#  else
+        LOG(warn3, log)
+            << "THP mode <madvise> not supported by this kernel "
+            "headers, using system policy.";
+#  endif
+    }
+
+    LOG(info3, log) << "Setting transparent huge pages to <" << thp << ">.";
+    if (-1 == ::prctl(PR_SET_THP_DISABLE, disable, flags, 0, 0)) {
+        std::system_error e(errno, std::system_category());
+        LOG(warn3, log)
+            << "Cannot set transparent huge pages to <" << thp << ">: <"
+            << e.code() << ", " << e.what() << ">.";
+    }
+#else
+    LOG(warn3, log) << "Transparent huge pages control not supported.";
+#endif
+}
+
+void mallocCtrl(const MallocConfig &config
+                , const std::vector<std::string> &args
+                , std::ostream &output)
+{
+    if (args.empty()) {
+        printOptional(output, "arenaMax", config.arenaMax);
+        printOptional(output, "trimThreshold", config.trimThreshold);
+        printOptional(output, "mmapThreshold", config.mmapThreshold);
+        output << "thp: " << thpStatus() << '\n';
+
+#ifdef SERVICE_HAS_MALLINFO2
+        const auto mi(::mallinfo2());
+        output << "arena: " << mi.arena
+               << "\nmmapped: " << mi.hblkhd
+               << "\nallocated: " << mi.uordblks
+               << "\nfree: " << mi.fordblks
+               << "\nreleasable: " << mi.keepcost
+               << '\n';
+#endif
+        mallocSummary(output);
+        return;
+    }
+
+    if (args.front() == "info") {
+        output << mallocInfo();
+        return;
+    }
+
+    if (args.front() == "trim") {
+        std::size_t pad(0);
+        if (args.size() > 1) {
+            try {
+                pad = boost::lexical_cast<std::size_t>(args[1]);
+            } catch (const boost::bad_lexical_cast&) {
+                utility::raise<utility::CtrlCommandError>
+                    ("invalid pad <%s>", args[1]);
+            }
+        }
+
+#ifdef __GLIBC__
+        const auto before(smapsRollup());
+        const auto released(::malloc_trim(pad));
+        const auto after(smapsRollup());
+
+        output << "released: " << (released ? "yes" : "no") << '\n';
+        if (before && after) {
+            output << "rss: " << before->rss << " kB -> " << after->rss
+                   << " kB\n";
+        }
+        return;
+#else
+        (void) pad;
+        utility::raise<utility::CtrlCommandError>
+            ("malloc trim not supported by this C library");
+#endif
+    }
+
+    utility::raise<utility::CtrlCommandError>
+        ("unknown malloc subcommand <%s>", args.front());
+}
+
+} } // namespace service::detail
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_malloc_hpp_included_
+#define shared_service_detail_malloc_hpp_included_
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+#include <boost/optional.hpp>
+#include <boost/program_options.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+namespace po = boost::program_options;
+
+namespace service { namespace detail {
+
+/** Allocator tuning (service.malloc.*, service.thp).
+ */
+struct MallocConfig {
+    boost::optional<int> arenaMax;
+    boost::optional<int> trimThreshold;
+    boost::optional<int> mmapThreshold;
+
+    /** always, madvise, never; empty = leave as is.
+     */
+    std::string thp;
+
+    void configuration(po::options_description &cmdline
+                       , po::options_description &config);
+
+    void configure(const po::variables_map &vars);
+
+    /** Applies configuration, failures are logged as warnings.
+     */
+    void apply(dbglog::module &log) const;
+};
+
+/** Handles "malloc [info|trim [pad]]" ctrl command.
+ */
+void mallocCtrl(const MallocConfig &config
+                , const std::vector<std::string> &args
+                , std::ostream &output);
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_malloc_hpp_included_
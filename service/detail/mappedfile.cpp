@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+#include "mappedfile.hpp"
+
+namespace service { namespace detail {
+
+namespace {
+
+std::string read(const boost::filesystem::path &path)
+{
+    std::ifstream f;
+    f.exceptions(std::ifstream::badbit);
+    f.open(path.string(), std::ios_base::in | std::ios_base::binary);
+    if (!f) {
+        throw std::system_error(errno ? errno : ENOENT
+                                , std::system_category());
+    }
+    return std::string((std::istreambuf_iterator<char>(f))
+                       , std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const boost::filesystem::path &path)
+    : data_(), size_(), mapped_(false), buffer_(read(path))
+{
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {}
+
+#else
+
+MappedFile::MappedFile(const boost::filesystem::path &path)
+    : data_(), size_(), mapped_(false)
+{
+    const auto fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd == -1) {
+        throw std::system_error(errno, std::system_category());
+    }
+
+    struct ::stat st;
+    if (-1 == ::fstat(fd, &st)) {
+        std::system_error e(errno, std::system_category());
+        ::close(fd);
+        throw e;
+    }
+
+    if (S_ISREG(st.st_mode) && (st.st_size > 0)) {
+        const std::size_t size(st.st_size);
+        auto addr(::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+        if (addr != MAP_FAILED) {
+            ::close(fd);
+            data_ = static_cast<const char*>(addr);
+            size_ = size;
+            mapped_ = true;
+            return;
+        }
+    }
+    ::close(fd);
+
+    // empty, special or unmappable file: read it
+    buffer_ = read(path);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile()
+{
+    if (mapped_) { ::munmap(const_cast<char*>(data_), size_); }
+}
+
+#endif
+
+MemoryStreamBuf::pos_type
+MemoryStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir
+                         , std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in)) { return pos_type(off_type(-1)); }
+
+    off_type base(0);
+    switch (dir) {
+    case std::ios_base::beg: base = 0; break;
+    case std::ios_base::cur: base = gptr() - eback(); break;
+    case std::ios_base::end: base = egptr() - eback(); break;
+    default: return pos_type(off_type(-1));
+    }
+
+    const auto pos(base + off);
+    if ((pos < 0) || (pos > (egptr() - eback()))) {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + pos, egptr());
+    return pos_type(pos);
+}
+
+MemoryStreamBuf::pos_type
+MemoryStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+} } // namespace service::detail
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_mappedfile_hpp_included_
+#define shared_service_detail_mappedfile_hpp_included_
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/utility/string_view.hpp>
+
+namespace service { namespace detail {
+
+/** Read-only view of whole file content.
+ *
+ *  Regular files are mapped into memory (posix), anything else (pipes,
+ *  /proc files, windows) is read into an internal buffer.
+ *
+ *  Throws std::system_error when file cannot be opened or read.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const boost::filesystem::path &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    boost::string_view content() const { return { data_, size_ }; }
+
+private:
+    const char *data_;
+    std::size_t size_;
+    bool mapped_;
+    std::string buffer_;
+};
+
+/** Input stream buffer over existing memory; no copy is made.
+ */
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const char *data, std::size_t size) {
+        auto p(const_cast<char*>(data));
+        setg(p, p, p + size);
+    }
+
+    MemoryStreamBuf(boost::string_view content)
+        : MemoryStreamBuf(content.data(), content.size())
+    {}
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir
+                     , std::ios_base::openmode which) override;
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+        override;
+};
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_mappedfile_hpp_included_
@@ -0,0 +1,264 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/resource.h>
+
+#include "procfs.hpp"
+
+namespace service { namespace detail {
+
+boost::optional<MemoryRollup> smapsRollup(::pid_t pid)
+{
+    if (!pid) { pid = ::getpid(); }
+
+    std::ifstream f("/proc/" + std::to_string(pid) + "/smaps_rollup");
+    if (!f) { return boost::none; }
+
+    MemoryRollup mr;
+    std::string key;
+    std::size_t value;
+    std::string unit;
+    // skip address range header
+    std::getline(f, key);
+    while (f >> key >> value >> unit) {
+        if (key == "Rss:") {
+            mr.rss = value;
+        } else if (key == "Pss:") {
+            mr.pss = value;
+        } else if (key == "Shared_Clean:") {
+            mr.sharedClean = value;
+        } else if (key == "Shared_Dirty:") {
+            mr.sharedDirty = value;
+        } else if (key == "Private_Clean:") {
+            mr.privateClean = value;
+        } else if (key == "Private_Dirty:") {
+            mr.privateDirty = value;
+        }
+    }
+
+    return mr;
+}
+
+namespace {
+
+std::chrono::microseconds toDuration(const ::timeval &tv)
+{
+    return std::chrono::seconds(tv.tv_sec)
+        + std::chrono::microseconds(tv.tv_usec);
+}
+
+std::size_t countFds()
+{
+    auto dir(::opendir("/proc/self/fd"));
+    if (!dir) { return 0; }
+    std::size_t count(0);
+    while (auto entry = ::readdir(dir)) {
+        if (entry->d_name[0] != '.') { ++count; }
+    }
+    ::closedir(dir);
+
+    // do not count descriptor used by opendir itself
+    return count ? (count - 1) : 0;
+}
+
+template <typename T>
+void delta(std::ostream &os, const ProcessUsage &current
+           , const boost::optional<ProcessUsage> &previous
+           , T ProcessUsage::*member)
+{
+    os << current.*member;
+    if (previous) {
+        const auto d(current.*member - (*previous).*member);
+        os << " (" << ((d >= 0) ? "+" : "") << d << ")";
+    }
+}
+
+double seconds(std::chrono::microseconds value)
+{
+    return value.count() / 1e6;
+}
+
+} // namespace
+
+std::vector<TaskStat> taskStats()
+{
+    std::vector<TaskStat> out;
+
+    auto dir(::opendir("/proc/self/task"));
+    if (!dir) { return out; }
+
+    const auto tick(1000.0 / ::sysconf(_SC_CLK_TCK));
+    const auto ms([&](unsigned long ticks) {
+        return std::chrono::milliseconds(static_cast<long>(ticks * tick));
+    });
+
+    while (auto entry = ::readdir(dir)) {
+        if (entry->d_name[0] == '.') { continue; }
+
+        const std::string base(std::string("/proc/self/task/")
+                               + entry->d_name);
+
+        std::string stat;
+        {
+            std::ifstream f(base + "/stat");
+            if (!std::getline(f, stat)) { continue; }
+        }
+
+        // comm may contain spaces and parentheses
+        const auto open(stat.find('('));
+        const auto close(stat.rfind(')'));
+        if ((open == std::string::npos) || (close == std::string::npos)) {
+            continue;
+        }
+
+        TaskStat ts;
+        ts.tid = std::atoi(entry->d_name);
+        ts.comm = stat.substr(open + 1, close - open - 1);
+
+        // fields after comm start with field 3 (state)
+        std::istringstream is(stat.substr(close + 2));
+        std::vector<std::string> fields;
+        for (std::string field; is >> field; ) { fields.push_back(field); }
+        if (fields.size() < 37) { continue; }
+
+        ts.state = fields[0][0];
+        ts.userTime = ms(std::stoul(fields[14 - 3]));
+        ts.systemTime = ms(std::stoul(fields[15 - 3]));
+        ts.lastCpu = std::stoi(fields[39 - 3]);
+
+        std::ifstream f(base + "/status");
+        std::string key;
+        while (f >> key) {
+            if (key == "voluntary_ctxt_switches:") {
+                f >> ts.voluntarySwitches;
+            } else if (key == "nonvoluntary_ctxt_switches:") {
+                f >> ts.involuntarySwitches;
+            }
+            f.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+
+        out.push_back(ts);
+    }
+    ::closedir(dir);
+
+    return out;
+}
+
+ProcessUsage ProcessUsage::sample()
+{
+    ProcessUsage pu;
+    pu.timestamp = std::chrono::steady_clock::now();
+
+    ::rusage ru;
+    if (!::getrusage(RUSAGE_SELF, &ru)) {
+        pu.peakRss = ru.ru_maxrss;
+        pu.minorFaults = ru.ru_minflt;
+        pu.majorFaults = ru.ru_majflt;
+        pu.voluntarySwitches = ru.ru_nvcsw;
+        pu.involuntarySwitches = ru.ru_nivcsw;
+        pu.userTime = toDuration(ru.ru_utime);
+        pu.systemTime = toDuration(ru.ru_stime);
+    }
+
+    {
+        std::ifstream f("/proc/self/status");
+        std::string key;
+        while (f >> key) {
+            if (key == "VmRSS:") {
+                f >> pu.rss;
+            } else if (key == "Threads:") {
+                f >> pu.threads;
+            }
+            f.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+    }
+
+    pu.fds = countFds();
+
+    ::rlimit rl;
+    if (!::getrlimit(RLIMIT_NOFILE, &rl)) { pu.fdLimit = rl.rlim_cur; }
+
+    return pu;
+}
+
+void UsageMonitor::print(std::ostream &os)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const auto now(std::chrono::steady_clock::now());
+    if (!current_ || ((now - current_->timestamp) >= minInterval_)) {
+        previous_ = current_;
+        current_ = ProcessUsage::sample();
+    }
+
+    const auto c(*current_);
+    const auto p(previous_);
+    lock.unlock();
+
+    os << "Rss: " << c.rss << " kB (peak " << c.peakRss << " kB)\n";
+
+    os << "Cpu-Time: user " << std::fixed << std::setprecision(3)
+       << seconds(c.userTime) << " s";
+    if (p) { os << " (+" << seconds(c.userTime - p->userTime) << ")"; }
+    os << ", system " << seconds(c.systemTime) << " s";
+    if (p) { os << " (+" << seconds(c.systemTime - p->systemTime) << ")"; }
+    if (p) {
+        const auto wall(std::chrono::duration_cast<std::chrono::microseconds>
+                        (c.timestamp - p->timestamp));
+        if (wall.count()) {
+            os << ", " << std::setprecision(1)
+               << (100.0 * seconds(c.userTime + c.systemTime
+                                   - p->userTime - p->systemTime)
+                   / seconds(wall))
+               << "% over " << seconds(wall) << " s";
+        }
+    }
+    os << std::defaultfloat << std::setprecision(6) << "\n";
+
+    os << "Faults: minor ";
+    delta(os, c, p, &ProcessUsage::minorFaults);
+    os << ", major ";
+    delta(os, c, p, &ProcessUsage::majorFaults);
+
+    os << "\nContext-Switches: voluntary ";
+    delta(os, c, p, &ProcessUsage::voluntarySwitches);
+    os << ", involuntary ";
+    delta(os, c, p, &ProcessUsage::involuntarySwitches);
+
+    os << "\nFds: " << c.fds << " / " << c.fdLimit
+       << "\nThreads: " << c.threads << "\n";
+}
+
+} } // namespace service::detail
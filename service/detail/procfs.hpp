@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_procfs_hpp_included_
+#define shared_service_detail_procfs_hpp_included_
+
+#include <cstddef>
+#include <chrono>
+#include <mutex>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <boost/optional.hpp>
+
+namespace service { namespace detail {
+
+/** Memory usage summary from /proc/<pid>/smaps_rollup, all values in kB.
+ */
+struct MemoryRollup {
+    std::size_t rss;
+    std::size_t pss;
+    std::size_t sharedClean;
+    std::size_t sharedDirty;
+    std::size_t privateClean;
+    std::size_t privateDirty;
+
+    MemoryRollup()
+        : rss(), pss(), sharedClean(), sharedDirty(), privateClean()
+        , privateDirty()
+    {}
+
+    std::size_t shared() const { return sharedClean + sharedDirty; }
+    std::size_t priv() const { return privateClean + privateDirty; }
+};
+
+/** Reads memory usage summary of given process (0 = this process).
+ *  Returns none if not available (old kernel, process gone).
+ */
+boost::optional<MemoryRollup> smapsRollup(::pid_t pid = 0);
+
+/** Per-thread information from /proc/self/task/<tid>/{stat,status}.
+ */
+struct TaskStat {
+    ::pid_t tid;
+    std::string comm;
+    char state;
+    int lastCpu;
+    std::chrono::milliseconds userTime;
+    std::chrono::milliseconds systemTime;
+    long voluntarySwitches;
+    long involuntarySwitches;
+
+    TaskStat()
+        : tid(), state('?'), lastCpu(-1), userTime(), systemTime()
+        , voluntarySwitches(), involuntarySwitches()
+    {}
+};
+
+/** Reads information about all threads of this process.
+ */
+std::vector<TaskStat> taskStats();
+
+/** Resource usage of this process (getrusage + /proc/self).
+ */
+struct ProcessUsage {
+    std::chrono::steady_clock::time_point timestamp;
+
+    /** Memory in kB.
+     */
+    std::size_t rss;
+    std::size_t peakRss;
+
+    long minorFaults;
+    long majorFaults;
+    long voluntarySwitches;
+    long involuntarySwitches;
+
+    std::chrono::microseconds userTime;
+    std::chrono::microseconds systemTime;
+
+    std::size_t fds;
+    std::size_t fdLimit;
+    std::size_t threads;
+
+    ProcessUsage()
+        : rss(), peakRss(), minorFaults(), majorFaults()
+        , voluntarySwitches(), involuntarySwitches(), userTime()
+        , systemTime(), fds(), fdLimit(), threads()
+    {}
+
+    static ProcessUsage sample();
+};
+
+/** Prints process usage with deltas since previous sample. Sampling is
+ *  rate limited: readings younger than minInterval are reused, so that
+ *  frequent monitor polling stays cheap.
+ */
+class UsageMonitor {
+public:
+    UsageMonitor(std::chrono::milliseconds minInterval
+                 = std::chrono::milliseconds(1000))
+        : minInterval_(minInterval)
+    {}
+
+    void print(std::ostream &os);
+
+private:
+    const std::chrono::milliseconds minInterval_;
+    std::mutex mutex_;
+    boost::optional<ProcessUsage> previous_;
+    boost::optional<ProcessUsage> current_;
+};
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_procfs_hpp_included_
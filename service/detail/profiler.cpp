@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <signal.h>
+#include <unistd.h>
+#include <execinfo.h>
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <system_error>
+
+#include <boost/filesystem.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "../threadregistry.hpp"
+#include "profiler.hpp"
+#include "symbolizer.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace service { namespace detail {
+
+namespace {
+
+/** Number of handlers currently running; incremented before active profiler
+ *  is checked so that stopping side can wait for them.
+ */
+std::atomic<int> inFlight(0);
+std::atomic<Profiler*> active(nullptr);
+
+/** Frames belonging to signal delivery (handler, trampoline).
+ */
+constexpr int SkipFrames = 2;
+
+/** Upper bound of preallocated samples.
+ */
+constexpr std::size_t MaxSamples = 1 << 16;
+
+} // namespace
+
+constexpr int Profiler::MaxDepth;
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : stopRequested_(false), capacity_(), next_(0), dropped_(0)
+    , handlerInstalled_(false)
+{}
+
+Profiler::~Profiler()
+{
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stopRequested_ = true;
+        }
+        cond_.notify_all();
+        thread_.join();
+    }
+}
+
+void Profiler::handler(int, ::siginfo_t*, void*)
+{
+    const auto savedErrno(errno);
+    ++inFlight;
+
+    if (auto profiler = active.load()) {
+        const auto index(profiler->next_.fetch_add
+                         (1, std::memory_order_relaxed));
+        if (index < profiler->capacity_) {
+            auto &sample(profiler->samples_[index]);
+            sample.tid = currentThreadId();
+            sample.depth = ::backtrace(sample.frames, MaxDepth);
+        } else {
+            profiler->dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    --inFlight;
+    errno = savedErrno;
+}
+
+void Profiler::start(unsigned int hz, std::chrono::seconds duration
+                     , const fs::path &output)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (status_.running) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Profiler is already running.";
+    }
+    if (!hz || (hz > 10000) || (duration.count() <= 0)) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Invalid profiler parameters (" << hz << " Hz, "
+            << duration.count() << " s).";
+    }
+
+    // previous run finished on timeout
+    if (thread_.joinable()) { thread_.join(); }
+
+    // backtrace(3) may allocate on first use (loads libgcc): do it now
+    void *dummy[1];
+    ::backtrace(dummy, 1);
+
+    capacity_ = std::min(MaxSamples, std::size_t(hz) * duration.count()
+                         * std::max(1u, std::thread::hardware_concurrency()));
+    samples_.reset(new Sample[capacity_]);
+    next_ = 0;
+    dropped_ = 0;
+
+    status_ = Status();
+    status_.running = true;
+    status_.hz = hz;
+    status_.output = output;
+    stopRequested_ = false;
+
+    if (!handlerInstalled_) {
+        struct sigaction sa;
+        std::memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = &Profiler::handler;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        ::sigemptyset(&sa.sa_mask);
+        if (-1 == ::sigaction(SIGPROF, &sa, nullptr)) {
+            std::system_error e(errno, std::system_category());
+            status_.running = false;
+            LOG(err2) << "Cannot install SIGPROF handler: <"
+                      << e.what() << ">.";
+            throw e;
+        }
+        handlerInstalled_ = true;
+    }
+
+    active = this;
+
+    const auto usec(1000000 / hz);
+    ::itimerval timer;
+    timer.it_interval.tv_sec = usec / 1000000;
+    timer.it_interval.tv_usec = usec % 1000000;
+    timer.it_value = timer.it_interval;
+    if (-1 == ::setitimer(ITIMER_PROF, &timer, nullptr)) {
+        std::system_error e(errno, std::system_category());
+        active = nullptr;
+        status_.running = false;
+        LOG(err2) << "Cannot start profiling timer: <" << e.what() << ">.";
+        throw e;
+    }
+
+    LOG(info3) << "Profiler started at " << hz << " Hz for "
+               << duration.count() << " s, output: " << output << ".";
+
+    thread_ = std::thread(&Profiler::run, this
+                          , std::chrono::steady_clock::now() + duration);
+}
+
+void Profiler::run(std::chrono::steady_clock::time_point deadline)
+{
+    auto registration(registerThread("profiler", "profiler"));
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_until(lock, deadline, [this]() { return stopRequested_; });
+    }
+
+    finish();
+}
+
+void Profiler::finish()
+{
+    // disarm timer, wait for running handlers; handler stays installed to
+    // swallow any SIGPROF still pending
+    ::itimerval timer;
+    std::memset(&timer, 0, sizeof(timer));
+    ::setitimer(ITIMER_PROF, &timer, nullptr);
+    active = nullptr;
+    while (inFlight.load()) { std::this_thread::yield(); }
+
+    try {
+        write();
+    } catch (const std::exception &e) {
+        LOG(err2) << "Failed to write profile to " << status_.output
+                  << ": " << e.what();
+    }
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    samples_.reset();
+    status_.running = false;
+}
+
+void Profiler::write()
+{
+    const auto count(std::min(next_.load(), capacity_));
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        status_.samples = count;
+        status_.dropped = dropped_.load();
+    }
+
+    std::map< ::pid_t, std::string> names;
+    for (const auto &thread : registeredThreads()) {
+        names[thread.tid] = thread.name;
+    }
+
+    Symbolizer symbolize;
+    std::map<std::string, std::size_t> stacks;
+    std::string stack;
+
+    for (std::size_t i(0); i < count; ++i) {
+        const auto &sample(samples_[i]);
+
+        auto fnames(names.find(sample.tid));
+        stack = ((fnames != names.end())
+                 ? fnames->second : ("tid-" + std::to_string(sample.tid)));
+
+        // root first
+        for (int f(sample.depth - 1); f >= SkipFrames; --f) {
+            // ';' separates frames in folded format
+            auto frame(symbolize(sample.frames[f]));
+            std::replace(frame.begin(), frame.end(), ';', ':');
+            stack.push_back(';');
+            stack.append(frame);
+        }
+        ++stacks[stack];
+    }
+
+    std::ofstream f;
+    f.exceptions(std::ios::badbit | std::ios::failbit);
+    f.open(status_.output.string(), std::ios_base::out | std::ios_base::trunc);
+    for (const auto &item : stacks) {
+        f << item.first << ' ' << item.second << '\n';
+    }
+    f.close();
+
+    LOG(info3) << "Profiler wrote " << count << " samples ("
+               << status_.dropped << " dropped) to " << status_.output
+               << ".";
+}
+
+Profiler::Status Profiler::stop()
+{
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!status_.running) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Profiler is not running.";
+        }
+        stopRequested_ = true;
+        thread = std::move(thread_);
+    }
+    cond_.notify_all();
+    if (thread.joinable()) { thread.join(); }
+
+    return status();
+}
+
+Profiler::Status Profiler::status() const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto s(status_);
+    if (s.running) {
+        s.samples = std::min(next_.load(), capacity_);
+        s.dropped = dropped_.load();
+    }
+    return s;
+}
+
+} } // namespace service::detail
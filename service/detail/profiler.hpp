@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_profiler_hpp_included_
+#define shared_service_detail_profiler_hpp_included_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+
+#include <signal.h>
+#include <sys/types.h>
+
+#include <boost/filesystem/path.hpp>
+
+namespace service { namespace detail {
+
+/** Sampling CPU profiler driven by ITIMER_PROF.
+ *
+ *  SIGPROF handler captures a backtrace into a preallocated sample buffer
+ *  (no allocation, no locks). When profiling ends (timeout or stop()) a
+ *  helper thread symbolizes samples and writes them in folded-stack format
+ *  (input of flamegraph.pl).
+ *
+ *  SIGPROF handler is installed on first start and kept afterwards (doing
+ *  nothing while profiler is off): SIGPROF still pending when the timer is
+ *  disarmed would kill the process under default disposition.
+ *
+ *  Process-wide singleton since signal handlers are.
+ */
+class Profiler {
+public:
+    static Profiler& instance();
+
+    struct Status {
+        bool running;
+        unsigned int hz;
+        std::size_t samples;
+        std::size_t dropped;
+        boost::filesystem::path output;
+
+        Status() : running(false), hz(), samples(), dropped() {}
+    };
+
+    /** Starts profiling, throws when already running.
+     */
+    void start(unsigned int hz, std::chrono::seconds duration
+               , const boost::filesystem::path &output);
+
+    /** Stops profiling and waits until output is written.
+     *  Returns final status; throws when not running.
+     */
+    Status stop();
+
+    Status status() const;
+
+    static constexpr int MaxDepth = 48;
+
+    struct Sample {
+        ::pid_t tid;
+        int depth;
+        void *frames[MaxDepth];
+    };
+
+private:
+    Profiler();
+    ~Profiler();
+
+    void run(std::chrono::steady_clock::time_point deadline);
+    void finish();
+    void write();
+
+    static void handler(int signo, ::siginfo_t *info, void *context);
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stopRequested_;
+    std::thread thread_;
+    Status status_;
+
+    std::unique_ptr<Sample[]> samples_;
+    std::size_t capacity_;
+    std::atomic<std::size_t> next_;
+    std::atomic<std::size_t> dropped_;
+
+    bool handlerInstalled_;
+};
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_profiler_hpp_included_
@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/mman.h>
+
+#include <cctype>
+#include <fstream>
+#include <system_error>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "resources.hpp"
+
+namespace ba = boost::algorithm;
+
+namespace service { namespace detail {
+
+namespace {
+
+struct Resource {
+    const char *name;
+    int resource;
+    const char *description;
+};
+
+const Resource resources[] = {
+    { "as", RLIMIT_AS, "address space size" }
+    , { "core", RLIMIT_CORE, "core file size" }
+    , { "data", RLIMIT_DATA, "data segment size" }
+    , { "fsize", RLIMIT_FSIZE, "file size" }
+    , { "memlock", RLIMIT_MEMLOCK, "locked memory size" }
+    , { "nofile", RLIMIT_NOFILE, "number of open files" }
+    , { "nproc", RLIMIT_NPROC, "number of processes" }
+    , { "stack", RLIMIT_STACK, "stack size" }
+};
+
+const Resource* findResource(const std::string &name)
+{
+    for (const auto &r : resources) {
+        if (name == r.name) { return &r; }
+    }
+    return nullptr;
+}
+
+/** Parses number with optional binary suffix (k, m, g) or "unlimited".
+ */
+::rlim_t parseValue(const std::string &option, std::string value)
+{
+    ba::trim(value);
+    if (value == "unlimited") { return RLIM_INFINITY; }
+
+    ::rlim_t multiplier(1);
+    if (!value.empty()) {
+        switch (std::tolower(value.back())) {
+        case 'k': multiplier = ::rlim_t(1) << 10; break;
+        case 'm': multiplier = ::rlim_t(1) << 20; break;
+        case 'g': multiplier = ::rlim_t(1) << 30; break;
+        }
+        if (multiplier != 1) { value.pop_back(); }
+    }
+
+    try {
+        return boost::lexical_cast< ::rlim_t>(value) * multiplier;
+    } catch (const boost::bad_lexical_cast&) {
+        throw po::error("Invalid value <" + value + "> of " + option + ".");
+    }
+}
+
+std::string formatValue(::rlim_t value)
+{
+    if (value == RLIM_INFINITY) { return "unlimited"; }
+    return boost::lexical_cast<std::string>(value);
+}
+
+} // namespace
+
+void ResourceConfig::configuration(po::options_description &cmdline
+                                   , po::options_description &config)
+{
+    (void) cmdline;
+
+    for (const auto &r : resources) {
+        config.add_options()
+            ((std::string("service.rlimit.") + r.name).c_str()
+             , po::value<std::string>()
+             , (std::string("Limit of ") + r.description
+                + ": soft[:hard], value is a number with optional "
+                "k/m/g suffix or \"unlimited\".").c_str())
+            ;
+    }
+
+    config.add_options()
+        ("service.mlockall", po::value<std::string>()
+         , "Lock memory: current, future or current,future.")
+        ("service.resourcesStrict", po::value(&strict)->default_value(strict)
+         , "Failure to apply service.rlimit.* or service.mlockall "
+         "is fatal (otherwise only a warning is logged).")
+        ;
+}
+
+void ResourceConfig::configure(const po::variables_map &vars)
+{
+    for (const auto &r : resources) {
+        const auto option(std::string("service.rlimit.") + r.name);
+        if (!vars.count(option)) { continue; }
+
+        const auto value(vars[option].as<std::string>());
+        Limit limit;
+
+        const auto colon(value.find(':'));
+        limit.soft = parseValue(option, value.substr(0, colon));
+        if (colon != std::string::npos) {
+            limit.hard = parseValue(option, value.substr(colon + 1));
+            limit.hasHard = true;
+            if ((limit.hard != RLIM_INFINITY)
+                && ((limit.soft == RLIM_INFINITY)
+                    || (limit.soft > limit.hard)))
+            {
+                throw po::error("Soft limit is above hard limit in "
+                                + option + ".");
+            }
+        }
+
+        limits[r.name] = limit;
+    }
+
+    if (vars.count("service.mlockall")) {
+        std::vector<std::string> flags;
+        const auto value(vars["service.mlockall"].as<std::string>());
+        ba::split(flags, value, ba::is_any_of(",|"));
+        for (auto flag : flags) {
+            ba::trim(flag);
+            if (flag == "current") {
+                mlockall |= MCL_CURRENT;
+            } else if (flag == "future") {
+                mlockall |= MCL_FUTURE;
+            } else {
+                throw po::error("Invalid value <" + value
+                                + "> of service.mlockall.");
+            }
+        }
+    }
+}
+
+bool ResourceConfig::apply(dbglog::module &log) const
+{
+    bool ok(true);
+
+    const auto failed([&](const std::string &what)
+    {
+        std::system_error e(errno, std::system_category());
+        if (strict) {
+            LOG(fatal, log) << what << ": <" << e.code() << ", "
+                            << e.what() << ">.";
+            ok = false;
+        } else {
+            LOG(warn3, log) << what << ": <" << e.code() << ", "
+                            << e.what() << ">.";
+        }
+    });
+
+    for (const auto &item : limits) {
+        const auto *r(findResource(item.first));
+        const auto &limit(item.second);
+
+        ::rlimit rl;
+        if (-1 == ::getrlimit(r->resource, &rl)) {
+            failed("Cannot get limit <" + item.first + ">");
+            continue;
+        }
+
+        rl.rlim_cur = limit.soft;
+        if (limit.hasHard) {
+            rl.rlim_max = limit.hard;
+        } else if ((rl.rlim_max != RLIM_INFINITY)
+                   && ((limit.soft == RLIM_INFINITY)
+                       || (limit.soft > rl.rlim_max)))
+        {
+            // raise hard limit to accommodate soft one
+            rl.rlim_max = limit.soft;
+        }
+
+        LOG(info3, log)
+            << "Setting limit <" << item.first << "> to "
+            << formatValue(rl.rlim_cur) << ":" << formatValue(rl.rlim_max)
+            << ".";
+        if (-1 == ::setrlimit(r->resource, &rl)) {
+            failed("Cannot set limit <" + item.first + ">");
+        }
+    }
+
+    if (mlockall) {
+        LOG(info3, log) << "Locking memory ("
+                        << ((mlockall & MCL_CURRENT) ? "current" : "")
+                        << (((mlockall & MCL_CURRENT)
+                             && (mlockall & MCL_FUTURE)) ? "," : "")
+                        << ((mlockall & MCL_FUTURE) ? "future" : "")
+                        << ").";
+        if (-1 == ::mlockall(mlockall)) {
+            failed("Cannot lock memory");
+        }
+    }
+
+    return ok;
+}
+
+void printResources(std::ostream &os)
+{
+    for (const auto &r : resources) {
+        ::rlimit rl;
+        if (-1 == ::getrlimit(r.resource, &rl)) { continue; }
+        os << "Rlimit-" << r.name << ": " << formatValue(rl.rlim_cur)
+           << " " << formatValue(rl.rlim_max) << "\n";
+    }
+
+    // locked memory from /proc
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while (std::getline(f, line)) {
+        if (!line.compare(0, 6, "VmLck:")) {
+            os << "Locked-Memory: " << ba::trim_copy(line.substr(6)) << "\n";
+            break;
+        }
+    }
+}
+
+} } // namespace service::detail
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_resources_hpp_included_
+#define shared_service_detail_resources_hpp_included_
+
+#include <map>
+#include <string>
+#include <iosfwd>
+
+#include <sys/resource.h>
+
+#include <boost/program_options.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+namespace po = boost::program_options;
+
+namespace service { namespace detail {
+
+/** Resource limits and memory locking (service.rlimit.*, service.mlockall).
+ *  Applied before persona switch since raising hard limits and locking
+ *  memory may need privileges.
+ */
+struct ResourceConfig {
+    struct Limit {
+        ::rlim_t soft;
+        ::rlim_t hard;
+        bool hasHard;
+
+        Limit() : soft(), hard(), hasHard(false) {}
+    };
+
+    /** Limits to set, indexed by short name (e.g. "nofile").
+     */
+    std::map<std::string, Limit> limits;
+
+    /** MCL_* flags for mlockall, 0 to skip.
+     */
+    int mlockall;
+
+    /** Failure to apply any setting is fatal (otherwise just a warning).
+     */
+    bool strict;
+
+    void configuration(po::options_description &cmdline
+                       , po::options_description &config);
+
+    void configure(const po::variables_map &vars);
+
+    /** Applies configuration. Returns false on (fatal) failure.
+     */
+    bool apply(dbglog::module &log) const;
+
+    ResourceConfig() : mlockall(), strict(true) {}
+};
+
+/** Prints effective limits of current process in monitor format.
+ */
+void printResources(std::ostream &os);
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_resources_hpp_included_
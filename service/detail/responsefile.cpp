@@ -0,0 +1,287 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "mappedfile.hpp"
+#include "responsefile.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace service { namespace detail {
+
+namespace {
+
+/** Character classes for the tokenizer.
+ */
+enum : unsigned char { Plain = 0, Space, Newline, Quote, DoubleQuote
+                       , Backslash };
+
+struct CharClasses {
+    unsigned char classes[256];
+
+    CharClasses() {
+        std::fill(std::begin(classes), std::end(classes), Plain);
+        for (unsigned char c : { ' ', '\t', '\r', '\f', '\v' }) {
+            classes[c] = Space;
+        }
+        classes[(unsigned char)('\n')] = Newline;
+        classes[(unsigned char)('\'')] = Quote;
+        classes[(unsigned char)('"')] = DoubleQuote;
+        classes[(unsigned char)('\\')] = Backslash;
+    }
+
+    unsigned char operator()(char c) const {
+        return classes[static_cast<unsigned char>(c)];
+    }
+};
+
+const CharClasses charClass;
+
+/** Returns length of line continuation (backslash-newline) at p, 0 if
+ *  there is none.
+ */
+inline std::size_t continuation(const char *p, const char *e)
+{
+    if ((p + 1 < e) && (p[1] == '\n')) { return 2; }
+    if ((p + 2 < e) && (p[1] == '\r') && (p[2] == '\n')) { return 3; }
+    return 0;
+}
+
+/** Legacy syntax: splits content at space, CR and LF only.
+ */
+template <typename OnArg>
+void tokenizePlain(boost::string_view content, OnArg onArg)
+{
+    const char *p(content.data());
+    const char *e(p + content.size());
+
+    const auto separator([](char c) {
+        return (c == ' ') || (c == '\n') || (c == '\r');
+    });
+
+    while (p < e) {
+        while ((p < e) && separator(*p)) { ++p; }
+        const auto b(p);
+        while ((p < e) && !separator(*p)) { ++p; }
+        if (p != b) { onArg(std::string(b, p), false); }
+    }
+}
+
+/** Splits content into arguments, calls onArg(std::string &&arg, bool
+ *  include) for each of them; include is true for unquoted '@...'.
+ */
+template <typename OnArg>
+void tokenizeShell(boost::string_view content, const std::string &name
+                   , OnArg onArg)
+{
+    const char *p(content.data());
+    const char *e(p + content.size());
+    unsigned int line(1);
+
+    std::string arg;
+    bool inArg(false);
+    bool include(false);
+
+    const auto error([&](const char *what, unsigned int line)
+    {
+        throw ResponseFileError
+            (name + ":" + std::to_string(line) + ": " + what + ".");
+    });
+
+    const auto emit([&]()
+    {
+        onArg(std::move(arg), include);
+        arg.clear();
+        inArg = include = false;
+    });
+
+    while (p < e) {
+        switch (charClass(*p)) {
+        case Newline:
+            ++line;
+            // fall through
+        case Space:
+            if (inArg) { emit(); }
+            ++p;
+            break;
+
+        case Quote: {
+            const auto start(line);
+            const auto end(static_cast<const char*>
+                           (std::memchr(p + 1, '\'', e - p - 1)));
+            if (!end) { error("unterminated single quote", start); }
+            line += std::count(p + 1, end, '\n');
+            arg.append(p + 1, end);
+            inArg = true;
+            p = end + 1;
+            break;
+        }
+
+        case DoubleQuote: {
+            const auto start(line);
+            inArg = true;
+            for (++p; ; ) {
+                const auto b(p);
+                while ((p < e) && (*p != '"') && (*p != '\\')) { ++p; }
+                line += std::count(b, p, '\n');
+                arg.append(b, p);
+
+                if (p == e) { error("unterminated double quote", start); }
+                if (*p == '"') { ++p; break; }
+
+                // backslash
+                if (const auto skip = continuation(p, e)) {
+                    p += skip;
+                    ++line;
+                } else if ((p + 1 < e) && ((p[1] == '"') || (p[1] == '\\')))
+                {
+                    arg.push_back(p[1]);
+                    p += 2;
+                } else {
+                    arg.push_back('\\');
+                    ++p;
+                }
+            }
+            break;
+        }
+
+        case Backslash:
+            if (const auto skip = continuation(p, e)) {
+                p += skip;
+                ++line;
+            } else if (p + 1 < e) {
+                arg.push_back(p[1]);
+                inArg = true;
+                p += 2;
+            } else {
+                // trailing backslash is taken literally
+                arg.push_back('\\');
+                inArg = true;
+                ++p;
+            }
+            break;
+
+        default: {
+            if (!inArg && (*p == '#')) {
+                // comment, newline is left for the next round
+                const auto eol(static_cast<const char*>
+                               (std::memchr(p, '\n', e - p)));
+                p = eol ? eol : e;
+                break;
+            }
+
+            // fast path: run of plain characters
+            if (!inArg && (*p == '@')) { include = true; }
+            const auto b(p);
+            while ((p < e) && (charClass(*p) == Plain)) { ++p; }
+            arg.append(b, p);
+            inArg = true;
+            break;
+        } }
+    }
+
+    if (inArg) { emit(); }
+}
+
+template <typename OnArg>
+void tokenize(boost::string_view content, ResponseFileReader::Syntax syntax
+              , const std::string &name, OnArg onArg)
+{
+    if (syntax == ResponseFileReader::Syntax::shell) {
+        tokenizeShell(content, name, onArg);
+    } else {
+        tokenizePlain(content, onArg);
+    }
+}
+
+} // namespace
+
+void ResponseFileReader::tokenize(boost::string_view content, Strings &args
+                                  , Syntax syntax, const std::string &name)
+{
+    detail::tokenize(content, syntax, name, [&](std::string &&arg, bool)
+    {
+        args.push_back(std::move(arg));
+    });
+}
+
+void ResponseFileReader::read(const fs::path &file)
+{
+    auto path(file);
+    if (!stack_.empty() && path.is_relative()) {
+        path = stack_.back().path.parent_path() / path;
+    }
+
+    std::unique_ptr<MappedFile> mapped;
+    try {
+        mapped.reset(new MappedFile(path));
+    } catch (const std::system_error &e) {
+        throw ResponseFileError("Unable to read response file "
+                                + path.string() + ": " + e.what() + ".");
+    }
+
+    boost::system::error_code ec;
+    auto canonical(fs::canonical(path, ec));
+    if (ec) { canonical = fs::absolute(path); }
+
+    if (std::find_if(stack_.begin(), stack_.end()
+                     , [&](const Frame &f) {
+                         return f.canonical == canonical;
+                     })
+        != stack_.end())
+    {
+        std::string chain;
+        for (const auto &f : stack_) { chain += f.path.string() + " -> "; }
+        throw ResponseFileError("Response file include cycle: "
+                                + chain + path.string() + ".");
+    }
+
+    if (loaded_) { loaded_(path, mapped->content()); }
+
+    stack_.push_back({ path, canonical });
+    struct Pop {
+        std::vector<Frame> &stack;
+        ~Pop() { stack.pop_back(); }
+    } pop{stack_};
+
+    detail::tokenize(mapped->content(), syntax_, path.string()
+                     , [&](std::string &&arg, bool include)
+    {
+        if (include && (arg.size() > 1)) {
+            read(fs::path(arg.substr(1)));
+        } else {
+            args_.push_back(std::move(arg));
+        }
+    });
+}
+
+} } // namespace service::detail
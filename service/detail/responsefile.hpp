@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_responsefile_hpp_included_
+#define shared_service_detail_responsefile_hpp_included_
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/utility/string_view.hpp>
+
+namespace service { namespace detail {
+
+/** Malformed or unreadable response file. Message contains file (and line
+ *  where applicable).
+ */
+struct ResponseFileError : std::runtime_error {
+    ResponseFileError(const std::string &msg) : std::runtime_error(msg) {}
+};
+
+/** Reads response files (@file) into list of arguments.
+ *
+ *  Plain syntax (default, compatible with existing files): arguments are
+ *  separated by space, CR or LF; everything else (including quotes,
+ *  backslashes and leading '@') is taken literally.
+ *
+ *  Shell syntax (opt-in, see ENABLE_SHELL_RESPONSE_FILES):
+ *    * arguments are separated by whitespace
+ *    * '...' is taken literally
+ *    * inside "..." backslash escapes only '"' and '\'
+ *    * outside quotes backslash escapes any character
+ *    * backslash-newline is a line continuation (except inside '...')
+ *    * unquoted '#' at the start of an argument starts a comment running
+ *      to the end of line; elsewhere it is an ordinary character
+ *    * unquoted argument starting with '@' includes another response
+ *      file in its place; relative paths are resolved against directory of
+ *      the including file; write '@' quoted to pass it literally
+ *
+ *  Include cycles are detected and reported as an error. NB: existing plain
+ *  files may change meaning under shell syntax (e.g. C:\data loses its
+ *  backslash, lone apostrophe is an error, @arg is an include, #arg is a
+ *  comment).
+ */
+class ResponseFileReader {
+public:
+    typedef std::vector<std::string> Strings;
+
+    enum class Syntax { plain, shell };
+
+    /** Called with content of each loaded file (including nested ones).
+     */
+    typedef std::function<void(const boost::filesystem::path &file
+                               , boost::string_view content)> Loaded;
+
+    ResponseFileReader(Syntax syntax = Syntax::plain
+                       , Loaded loaded = Loaded())
+        : syntax_(syntax), loaded_(loaded)
+    {}
+
+    /** Reads given response file (and its includes) and appends arguments
+     *  to args(). Throws ResponseFileError on failure.
+     */
+    void read(const boost::filesystem::path &file);
+
+    Strings& args() { return args_; }
+    const Strings& args() const { return args_; }
+
+    /** Tokenizes content without include processing: unquoted '@file'
+     *  arguments are passed through. Throws ResponseFileError on syntax
+     *  error, name is used in the message.
+     */
+    static void tokenize(boost::string_view content, Strings &args
+                         , Syntax syntax = Syntax::plain
+                         , const std::string &name = "<memory>");
+
+private:
+    /** File being read; canonical path is used for cycle detection.
+     */
+    struct Frame {
+        boost::filesystem::path path;
+        boost::filesystem::path canonical;
+    };
+
+    Syntax syntax_;
+    Loaded loaded_;
+    Strings args_;
+    std::vector<Frame> stack_;
+};
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_responsefile_hpp_included_
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_sharedmemory_hpp_included_
+#define shared_service_detail_sharedmemory_hpp_included_
+
+#include <cstddef>
+#include <stdexcept>
+
+#include <boost/noncopyable.hpp>
+
+#include <boost/interprocess/anonymous_shared_memory.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+namespace service { namespace detail {
+
+/** Bump allocator in anonymous shared memory. Memory is shared with all
+ *  processes forked after construction.
+ */
+class Allocator : boost::noncopyable {
+public:
+    Allocator(std::size_t size)
+        : mem_(boost::interprocess::anonymous_shared_memory(size))
+        , size_(size), offset_()
+    {}
+
+    template <typename T>
+    T* get(std::size_t count = 1) {
+        auto offset(offset_);
+        auto al(alignof(T));
+        auto misalign(offset % al);
+        if (misalign) {
+            offset += (al - misalign);
+        }
+
+        if ((offset > size_) || (sizeof(T) * count > (size_ - offset))) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Shared memory exhausted: cannot allocate "
+                << (sizeof(T) * count) << " bytes at offset " << offset
+                << " of " << size_ << ".";
+        }
+
+        auto data(static_cast<char*>(mem_.get_address()) + offset);
+        offset_ = offset + sizeof(T) * count;
+        return reinterpret_cast<T*>(data);
+    }
+
+private:
+    boost::interprocess::mapped_region mem_;
+    std::size_t size_;
+    std::size_t offset_;
+};
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_sharedmemory_hpp_included_
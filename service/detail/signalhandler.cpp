@@ -28,14 +28,20 @@
 #include <unistd.h>
 #include <sys/stat.h>
 
+#include <sstream>
 #include <system_error>
 
 #include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include "dbglog/dbglog.hpp"
 #include "utility/parse.hpp"
+#include "utility/tcpendpoint-io.hpp"
+
+#include "../threadregistry.hpp"
 
 #include "signalhandler.hpp"
+#include "stacks.hpp"
 
 namespace service { namespace detail {
 
@@ -83,9 +89,32 @@ SignalHandler::SignalHandler(dbglog::module &log, Service &owner
                  std::atomic<std::uint64_t>(0))
     , lastStatEvent_(0)
     , log_(log), owner_(owner), mainPid_(mainPid)
-    , ctrl_(ios_)
+    , ctrl_(ctrlIos_)
+    , netCtrl_(ctrlIos_), ctrlAllowLegacy_(false)
 {
-    if (ctrlConfig) {
+    if (ctrlConfig && !ctrlConfig->listen.empty()) {
+        const utility::TcpEndpoint e
+            (ctrlConfig->listen
+             , utility::TcpEndpoint::ParseFlags::allowResolve);
+        netCtrl_.open(e.value.protocol());
+        netCtrl_.set_option(asio::socket_base::reuse_address(true));
+        netCtrl_.bind(e.value);
+        netCtrl_.listen();
+
+        ctrlSecrets_ = ctrlConfig->secrets;
+        ctrlAllowLegacy_ = ctrlConfig->allowLegacyAuth;
+        if (ctrlConfig->sessionTtl > 0) {
+            ctrlSessions_.reset(new CtrlSessionTokens
+                                (std::chrono::seconds
+                                 (ctrlConfig->sessionTtl)));
+        }
+
+        LOG(info3, log_)
+            << "Listening for network control connections at "
+            << e.value << ".";
+    }
+
+    if (ctrlConfig && !ctrlConfig->path.empty()) {
         ctrlPath_ = ctrlConfig->path;
         local::stream_protocol::endpoint e(ctrlPath_->string());
         ctrl_.open(e.protocol());
@@ -128,12 +157,20 @@ SignalHandler::SignalHandler(dbglog::module &log, Service &owner
 SignalHandler::~SignalHandler()
 {
     utility::AtFork::remove(this);
+    removeCtrlSocket();
+}
+
+void SignalHandler::removeCtrlSocket()
+{
+    stopCtrlThread();
+    stopAccept();
 
     // remove ctrl path if in main process
     if (ctrlPath_ && (::getpid() == mainPid_)) {
         // try to remove control socket, ignore failure
         boost::system::error_code ec;
         remove_all(*ctrlPath_, ec);
+        ctrlPath_ = boost::none;
     }
 }
 
@@ -179,13 +216,14 @@ bool SignalHandler::process()
     return terminated_ || thisTerminated_;
 }
 
-void SignalHandler::globalTerminate(bool value, ::pid_t pid)
+bool SignalHandler::globalTerminate(bool value, ::pid_t pid)
 {
     if (value) {
-        terminator_.add(pid);
-    } else {
-        terminator_.remove(pid);
+        return terminator_.add(pid);
     }
+
+    terminator_.remove(pid);
+    return true;
 }
 
 void SignalHandler::startSignals()
@@ -199,15 +237,58 @@ void SignalHandler::start()
 {
     startSignals();
     startAccept();
+    startCtrlThread();
 }
 
 void SignalHandler::stop()
 {
     signals_.cancel();
 
+    // acceptor must not be touched while ctrl thread is running
+    stopCtrlThread();
     stopAccept();
 }
 
+void SignalHandler::startCtrlThread()
+{
+    if ((!ctrl_.is_open() && !netCtrl_.is_open())
+        || ctrlThread_.joinable())
+    {
+        return;
+    }
+
+    ctrlWork_.emplace(ctrlIos_);
+    ctrlThread_ = std::thread(&SignalHandler::ctrlThread, this);
+}
+
+void SignalHandler::stopCtrlThread()
+{
+    if (!ctrlThread_.joinable()) { return; }
+
+    ctrlWork_ = boost::none;
+    ctrlIos_.stop();
+    ctrlThread_.join();
+
+    // allow restart (after fork)
+    ctrlIos_.reset();
+}
+
+void SignalHandler::ctrlThread()
+{
+    auto registration(registerThread("ctrl", "ctrl"));
+
+    for (;;) {
+        try {
+            ctrlIos_.run();
+            return;
+        } catch (const std::exception &e) {
+            LOG(err3, log_)
+                << "Uncaught exception in ctrl thread: <" << e.what()
+                << ">. Going on.";
+        }
+    }
+}
+
 void SignalHandler::signal(const boost::system::error_code &e, int signo)
 {
     if (e) {
@@ -280,14 +361,24 @@ public:
     typedef lib::shared_ptr<CtrlConnection> pointer;
 
     CtrlConnection(Service &owner, asio::io_service &ios
+                   , asio::io_service &mainIos
                    , SignalHandler &sh, dbglog::module &log)
-        : owner_(owner), socket_(ios), strand_(ios), sh_(sh), log_(log)
-        , closed_(false)
+        : owner_(owner), socket_(ios), strand_(ios), mainIos_(mainIos)
+        , sh_(sh), log_(log), closed_(false), writing_(false)
     {}
 
     ~CtrlConnection() {}
 
-    local::stream_protocol::socket& socket() { return socket_; }
+    asio::generic::stream_protocol::socket& socket() { return socket_; }
+
+    /** Connection must pass network handshake before any command.
+     */
+    void requireAuth(const CtrlServerHandshake::SecretLookup &lookup
+                     , const CtrlSessionTokens *tokens, bool allowLegacy)
+    {
+        handshake_.reset(new CtrlServerHandshake
+                         (lookup, tokens, allowLegacy));
+    }
 
     void startRead();
 
@@ -298,27 +389,68 @@ public:
                      , std::size_t bytes);
 
 private:
+    /** Runs command and writes its output to given stream.
+     */
+    void execute(const Service::CtrlCommand &cmd, std::ostream &os);
+
+    /** Queues command reply and reads next command.
+     */
+    void reply(const std::string &output, bool terminateBlock);
+
+    /** Starts writing pending output unless write is already in progress.
+     *  Needed for pipelined requests: replies are queued while previous
+     *  reply is still being written.
+     */
+    void startWrite();
+
+    /** Feeds line to the handshake. Closes connection on failure.
+     */
+    void authenticate(const std::string &line);
+
     Service &owner_;
-    local::stream_protocol::socket socket_;
+    asio::generic::stream_protocol::socket socket_;
     asio::io_service::strand strand_;
+    asio::io_service &mainIos_;
     SignalHandler &sh_;
     dbglog::module &log_;
 
     boost::asio::streambuf input_;
     boost::asio::streambuf output_;
+    boost::asio::streambuf pending_;
 
     bool closed_;
+    bool writing_;
+    std::unique_ptr<CtrlServerHandshake> handshake_;
 };
 
 void SignalHandler::startAccept()
 {
-    if (!ctrl_.is_open()) { return; }
+    startAccept(false);
+    startAccept(true);
+}
+
+void SignalHandler::startAccept(bool net)
+{
+    if (!(net ? netCtrl_.is_open() : ctrl_.is_open())) { return; }
+
+    auto con(lib::make_shared<CtrlConnection>
+               (owner_, ctrlIos_, ios_, *this, log_));
+    const auto handler(lib::bind(&SignalHandler::newCtrlConnection, this
+                                 , placeholders::_1, con, net));
 
-    auto con(lib::make_shared<CtrlConnection>(owner_, ios_, *this, log_));
-    ctrl_.async_accept
-        (con->socket()
-         , lib::bind(&SignalHandler::newCtrlConnection, this
-                       , placeholders::_1, con));
+    if (!net) {
+        ctrl_.async_accept(con->socket(), handler);
+        return;
+    }
+
+    con->requireAuth([this](const std::string &component)
+                     -> boost::optional<std::string>
+    {
+        auto fsecrets(ctrlSecrets_.find(component));
+        if (fsecrets == ctrlSecrets_.end()) { return boost::none; }
+        return fsecrets->second;
+    }, ctrlSessions_.get(), ctrlAllowLegacy_);
+    netCtrl_.async_accept(con->socket(), handler);
 }
 
 void SignalHandler::stopAccept()
@@ -327,18 +459,24 @@ void SignalHandler::stopAccept()
         ctrl_.cancel();
         ctrl_.close();
     }
+    if (netCtrl_.is_open()) {
+        netCtrl_.cancel();
+        netCtrl_.close();
+    }
 }
 
 void SignalHandler::newCtrlConnection(const boost::system::error_code &e
-                                      , CtrlConnection::pointer con)
+                                      , CtrlConnection::pointer con
+                                      , bool net)
 {
     if (!e) {
-        LOG(info2, log_) << "New control connection.";
+        LOG(info2, log_) << "New " << (net ? "network " : "")
+                         << "control connection.";
         con->startRead();
     }
 
     if (e.value() != asio::error::operation_aborted) {
-        startAccept();
+        startAccept(net);
     }
 }
 
@@ -348,10 +486,10 @@ void CtrlConnection::startRead()
 
     asio::async_read_until
          (socket_, input_, "\n"
-         , lib::bind(&CtrlConnection::lineRead
-                     , shared_from_this()
-                     , placeholders::_1
-                     , placeholders::_2));
+         , strand_.wrap(lib::bind(&CtrlConnection::lineRead
+                                  , shared_from_this()
+                                  , placeholders::_1
+                                  , placeholders::_2)));
 }
 
 void CtrlConnection::lineRead(const boost::system::error_code &e
@@ -372,80 +510,167 @@ void CtrlConnection::lineRead(const boost::system::error_code &e
     std::string line;
     std::getline(is, line);
 
-    std::ostream os(&output_);
+    if (handshake_ && !handshake_->authenticated()) {
+        authenticate(line);
+        return;
+    }
 
     auto cmdValue(utility::separated_values::split<std::vector<std::string> >
                   (line, " \t"));
 
+    if (cmdValue.empty()) {
+        reply("empty command received\n", true);
+        return;
+    }
+
     bool terminateBlock(true);
 
-    if (cmdValue.empty()) {
-        os << "empty command received\n";
-    } else {
-        auto &front(cmdValue.front());
-        if (!front.empty() && (front[0] == '!')) {
-            // close after command
-            front = front.substr(1);
-            closed_ = true;
-            terminateBlock = false;
-        }
+    auto &front(cmdValue.front());
+    if (!front.empty() && (front[0] == '!')) {
+        // close after command
+        front = front.substr(1);
+        closed_ = true;
+        terminateBlock = false;
+    }
 
-        Service::CtrlCommand cmd
-            (front, std::next(cmdValue.begin()), cmdValue.end());
+    Service::CtrlCommand cmd
+        (front, std::next(cmdValue.begin()), cmdValue.end());
 
-        try {
-            if (cmd.cmd == "logrotate") {
-                sh_.logRotate();
-                os << "log rotation scheduled\n";
-            } else if (cmd.cmd == "terminate") {
-                sh_.terminate();
-                os << "termination scheduled, bye\n";
-            } else if (cmd.cmd == "exit") {
-                closed_ = true;
-                terminateBlock = false;
-            } else if (cmd.cmd == "help") {
-                os << "logrotate      schedules log reopen event\n"
-                   << "terminate      schedules termination event\n"
-                   << "help           shows this help\n"
-                    ;
-
-                // let owner to append its own help
-                owner_.processCtrl(cmd, os);
-            } else {
-                owner_.processCtrl(cmd, os);
+    if (cmd.cmd == "exit") {
+        closed_ = true;
+        reply(std::string(), false);
+        return;
+    }
+
+    if ((cmd.cmd == "stacks") || (cmd.cmd == "logrotate")
+        || (cmd.cmd == "terminate"))
+    {
+        // handled right here in the ctrl thread
+        std::ostringstream os;
+        execute(cmd, os);
+        reply(os.str(), terminateBlock);
+        return;
+    }
+
+    // run in the main loop, hand reply back to this connection's strand;
+    // next command is not read until then, keeping replies in order
+    auto self(shared_from_this());
+    mainIos_.post([self, cmd, terminateBlock]()
+    {
+        std::ostringstream os;
+        self->execute(cmd, os);
+        self->strand_.post(lib::bind(&CtrlConnection::reply, self
+                                     , os.str(), terminateBlock));
+    });
+}
+
+void CtrlConnection::authenticate(const std::string &line)
+{
+    std::string out;
+    try {
+        out = handshake_->process(line);
+    } catch (const std::exception &e) {
+        LOG(warn3, log_)
+            << "Network control connection not authenticated: "
+            << e.what();
+        closed_ = true;
+        reply("error: authentication failed\n", true);
+        return;
+    }
+
+    if (handshake_->authenticated()) {
+        LOG(info2, log_) << "Network control connection authenticated as <"
+                         << handshake_->component() << ">.";
+    }
+
+    if (!out.empty()) { out.push_back('\n'); }
+    reply(out, true);
+}
+
+void CtrlConnection::execute(const Service::CtrlCommand &cmd
+                             , std::ostream &os)
+{
+    try {
+        if (cmd.cmd == "logrotate") {
+            sh_.logRotate();
+            os << "log rotation scheduled\n";
+        } else if (cmd.cmd == "terminate") {
+            sh_.terminate();
+            os << "termination scheduled, bye\n";
+        } else if (cmd.cmd == "stacks") {
+            std::chrono::milliseconds timeout(1000);
+            if (!cmd.args.empty()) {
+                timeout = std::chrono::milliseconds
+                    (boost::lexical_cast<unsigned int>(cmd.args.front()));
             }
-        } catch (const utility::CtrlCommandError &e) {
-            LOG(err3, log_)
-                << "Error during handling ctrl command: " << e.what();
-            os << "error: " << e.what() << " \n";
-        } catch (const std::exception &e) {
-            LOG(err3, log_)
-                << "Error during handling ctrl command: " << e.what();
-            os << "error: failed to execute command\n";
+            printStacks(os, timeout);
+        } else if (cmd.cmd == "help") {
+            os << "logrotate      schedules log reopen event\n"
+               << "terminate      schedules termination event\n"
+               << "stacks [ms]    prints stacks of all registered threads "
+                  "(works even when main loop is stuck)\n"
+               << "help           shows this help\n"
+                ;
+
+            // let owner to append its own help
+            owner_.processCtrl(cmd, os);
+        } else {
+            owner_.processCtrl(cmd, os);
         }
+    } catch (const utility::CtrlCommandError &e) {
+        LOG(err3, log_)
+            << "Error during handling ctrl command: " << e.what();
+        os << "error: " << e.what() << " \n";
+    } catch (const boost::bad_lexical_cast&) {
+        LOG(err3, log_)
+            << "Invalid argument of ctrl command <" << cmd.cmd << ">.";
+        os << "error: invalid argument \n";
+    } catch (const std::exception &e) {
+        LOG(err3, log_)
+            << "Error during handling ctrl command: " << e.what();
+        os << "error: failed to execute command\n";
     }
+}
+
+void CtrlConnection::reply(const std::string &output, bool terminateBlock)
+{
+    std::ostream os(&pending_);
+    os << output;
 
     if (terminateBlock) {
         // terminate response block
         os << '\4';
     }
 
+    startWrite();
+
+    if (!closed_) {
+        // ready to read next command
+        startRead();
+    }
+}
+
+void CtrlConnection::startWrite()
+{
+    if (writing_ || !pending_.size()) { return; }
+
+    // move pending data to output buffer
+    std::ostream(&output_) << &pending_;
+    writing_ = true;
+
     asio::async_write
         (socket_, output_
          , strand_.wrap(lib::bind(&CtrlConnection::handleWrite
                                   , shared_from_this()
                                   , placeholders::_1
                                   , placeholders::_2)));
-
-    if (!closed_) {
-        // ready to read next command
-        startRead();
-    }
 }
 
 void CtrlConnection::handleWrite(const boost::system::error_code &e
                                  , std::size_t bytes)
 {
+    writing_ = false;
+
     if (e) {
         if (e.value() != asio::error::broken_pipe) {
             LOG(err2, log_) << "Control connection error: " << e;
@@ -457,24 +682,41 @@ void CtrlConnection::handleWrite(const boost::system::error_code &e
 
     LOG(debug, log_) << "Read: " << bytes << " bytes.";
 
-    if (closed_ && !output_.size()) {
+    if (pending_.size()) {
+        // more replies queued in the meantime
+        startWrite();
+    } else if (closed_ && !output_.size()) {
         socket_.close();
     }
 }
 
 void SignalHandler::atFork(utility::AtFork::Event event)
 {
+    // ctrl thread is stopped over fork (and not restarted in the child); it
+    // must not hold any lock the child could need
+    const bool inCtrlThread(std::this_thread::get_id()
+                            == ctrlThread_.get_id());
+
     switch (event) {
     case utility::AtFork::prepare:
+        if (!inCtrlThread) { stopCtrlThread(); }
         ios_.notify_fork(asio::io_service::fork_prepare);
+        ctrlIos_.notify_fork(asio::io_service::fork_prepare);
         break;
 
     case utility::AtFork::parent:
         ios_.notify_fork(asio::io_service::fork_parent);
+        ctrlIos_.notify_fork(asio::io_service::fork_parent);
+        startCtrlThread();
         break;
 
     case utility::AtFork::child:
         ios_.notify_fork(asio::io_service::fork_child);
+        ctrlIos_.notify_fork(asio::io_service::fork_child);
+        if (ctrlThread_.joinable()) {
+            // thread does not exist in the child
+            ctrlThread_.detach();
+        }
         stopAccept();
         break;
     }
@@ -515,6 +757,20 @@ void CtrlConfig::configuration(po::options_description &cmdline
          , "Change group of ctrl socket if set.")
         ("ctrl.mode", po::value<ModeParser>()
          , "Change permissions of control socket if set.")
+        ("ctrl.listen", po::value(&listen)
+         , "Network control endpoint (host:port). Clients must "
+         "authenticate with one of ctrl.secret credentials.")
+        ("ctrl.secret", po::value<std::vector<std::string> >()
+         , "Network control credentials as component:secret, "
+         "can be repeated.")
+        ("ctrl.sessionTtl", po::value(&sessionTtl)
+         ->default_value(sessionTtl)
+         , "Lifetime of network control sessions in seconds, "
+         "0 disables session resumption.")
+        ("ctrl.allowLegacyAuth", po::value(&allowLegacyAuth)
+         ->default_value(allowLegacyAuth)->implicit_value(true)
+         , "Accept legacy md5 challenge response on network control "
+         "connections.")
         ;
 }
 
@@ -523,6 +779,26 @@ void CtrlConfig::configure(const po::variables_map &vars)
     if (vars.count("ctrl.mode")) {
         mode = vars["ctrl.mode"].as<ModeParser>().mode;
     }
+
+    if (vars.count("ctrl.secret")) {
+        for (const auto &item
+                 : vars["ctrl.secret"].as<std::vector<std::string> >())
+        {
+            const auto colon(item.find(':'));
+            if (!colon || (colon == std::string::npos)
+                || (colon + 1 == item.size()))
+            {
+                // NB: value not reported, it might be the secret itself
+                throw po::error("Invalid ctrl.secret, expected "
+                                "component:secret.");
+            }
+            secrets[item.substr(0, colon)] = item.substr(colon + 1);
+        }
+    }
+
+    if (!listen.empty() && secrets.empty()) {
+        throw po::error("ctrl.listen requires at least one ctrl.secret.");
+    }
 }
 
 } } // namespace service::detail
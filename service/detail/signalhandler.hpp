@@ -28,11 +28,13 @@
 
 #include <memory>
 #include <set>
+#include <map>
+#include <thread>
 
 #include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
 #include <boost/asio.hpp>
 
-#include <boost/interprocess/anonymous_shared_memory.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 
@@ -46,6 +48,9 @@
 #include "utility/atfork.hpp"
 
 #include "../service.hpp"
+#include "../ctrlhandshake.hpp"
+
+#include "sharedmemory.hpp"
 
 namespace bi = boost::interprocess;
 namespace asio = boost::asio;
@@ -58,36 +63,6 @@ namespace service { namespace detail {
 namespace lib = std;
 namespace placeholders = std::placeholders;
 
-class Allocator : boost::noncopyable {
-public:
-    Allocator(std::size_t size)
-        : mem_(bi::anonymous_shared_memory(size))
-        , size_(size), offset_()
-    {}
-
-    template <typename T>
-    T* get(std::size_t count = 1) {
-        auto al(alignof(T));
-        auto misalign(offset_ % al);
-        if (misalign) {
-            offset_ += (al - misalign);
-        }
-
-        // TODO: check size
-        auto data(static_cast<char*>(mem_.get_address()) + offset_);
-        offset_ += sizeof(T) * count;
-        return reinterpret_cast<T*>(data);
-    }
-
-private:
-    bi::mapped_region mem_;
-#ifdef __clang__
-    [[maybe_unused]]
-#endif
-    std::size_t size_; // TODO: check size
-    std::size_t offset_;
-};
-
 class Terminator : boost::noncopyable {
 public:
     Terminator(Allocator &mem, std::size_t size)
@@ -113,7 +88,7 @@ public:
         ScopedLock guard(lock_);
         if (!pid) { pid = ::getpid(); }
         auto p(find(pid));
-        if (p) { p = 0; }
+        if (p) { *p = 0; }
     }
 
     bool find() {
@@ -146,12 +121,29 @@ struct CtrlConfig {
     std::string group;
     ::mode_t mode;
 
+    /** Network ctrl endpoint (host:port), disabled if empty. Network
+     *  connections must authenticate (see CtrlServerHandshake).
+     */
+    std::string listen;
+
+    /** Network ctrl secrets: component -> secret.
+     */
+    std::map<std::string, std::string> secrets;
+
+    /** Network ctrl session lifetime in seconds, 0 disables resumption.
+     */
+    long sessionTtl;
+
+    /** Accept legacy md5 challenge response on network ctrl.
+     */
+    bool allowLegacyAuth;
+
     void configuration(po::options_description &cmdline
                        , po::options_description &config);
 
     void configure(const po::variables_map &vars);
 
-    CtrlConfig() : mode() {}
+    CtrlConfig() : mode(), sessionTtl(3600), allowLegacyAuth(false) {}
 };
 
 class CtrlConnection;
@@ -179,7 +171,9 @@ public:
      */
     bool process();
 
-    void globalTerminate(bool value, ::pid_t pid);
+    /** Returns false if process cannot be added (no free slot).
+     */
+    bool globalTerminate(bool value, ::pid_t pid);
 
     void logRotate();
 
@@ -187,6 +181,11 @@ public:
      */
     void registerSignal(int signo);
 
+    /** Stops serving control connections and removes control socket (if
+     *  in main process). Called from destructor.
+     */
+    void removeCtrlSocket();
+
 private:
     void start();
 
@@ -200,10 +199,25 @@ private:
 
     void startAccept();
 
+    /** Accepts next connection on unix (net = false) or network ctrl
+     *  socket.
+     */
+    void startAccept(bool net);
+
     void stopAccept();
 
     void newCtrlConnection(const boost::system::error_code &e
-                           , lib::shared_ptr<CtrlConnection> con);
+                           , lib::shared_ptr<CtrlConnection> con, bool net);
+
+    /** Control connections are served by a dedicated thread so that
+     *  diagnostic commands (e.g. stacks) work even when the main loop is
+     *  stuck. Other commands are still executed in process().
+     */
+    void startCtrlThread();
+
+    void stopCtrlThread();
+
+    void ctrlThread();
 
     void atFork(utility::AtFork::Event event);
 
@@ -224,7 +238,16 @@ private:
 
     // control support
     boost::optional<fs::path> ctrlPath_;
+    asio::io_service ctrlIos_;
+    boost::optional<asio::io_service::work> ctrlWork_;
+    std::thread ctrlThread_;
     local::stream_protocol::acceptor ctrl_;
+
+    // network control support
+    asio::ip::tcp::acceptor netCtrl_;
+    std::map<std::string, std::string> ctrlSecrets_;
+    std::unique_ptr<CtrlSessionTokens> ctrlSessions_;
+    bool ctrlAllowLegacy_;
 };
 
 } } // namespace service::detail
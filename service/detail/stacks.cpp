@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <signal.h>
+#include <unistd.h>
+#include <execinfo.h>
+#ifdef __linux__
+#  include <sys/syscall.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <system_error>
+
+#include "dbglog/dbglog.hpp"
+
+#include "../threadregistry.hpp"
+#include "stacks.hpp"
+#include "symbolizer.hpp"
+
+namespace service { namespace detail {
+
+namespace {
+
+constexpr int MaxDepth = 64;
+constexpr std::size_t MaxThreads = 256;
+
+/** Frames belonging to signal delivery (handler, trampoline).
+ */
+constexpr int SkipFrames = 2;
+
+enum SlotState : int { idle, requested, capturing, done };
+
+/** One slot per signalled thread. Handler claims the slot by switching
+ *  requested -> capturing so that the requester never reuses a slot that is
+ *  being written to.
+ */
+struct Slot {
+    std::atomic<int> state;
+    std::atomic< ::pid_t> tid;
+    int depth;
+    void *frames[MaxDepth];
+};
+
+Slot slots[MaxThreads];
+
+std::mutex mutex;
+
+#ifdef __linux__
+
+int stackSignal() { return SIGRTMIN + 4; }
+
+void handler(int, ::siginfo_t*, void*)
+{
+    const auto savedErrno(errno);
+    const auto tid(currentThreadId());
+
+    for (auto &slot : slots) {
+        if (slot.tid.load(std::memory_order_acquire) != tid) { continue; }
+        int expected(requested);
+        if (!slot.state.compare_exchange_strong(expected, capturing)) {
+            continue;
+        }
+        slot.depth = ::backtrace(slot.frames, MaxDepth);
+        slot.state.store(done, std::memory_order_release);
+        break;
+    }
+
+    errno = savedErrno;
+}
+
+void install()
+{
+    static bool installed(false);
+    if (installed) { return; }
+
+    // backtrace(3) may allocate on first use (loads libgcc): do it now
+    void *dummy[1];
+    ::backtrace(dummy, 1);
+
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = &handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    ::sigemptyset(&sa.sa_mask);
+    if (-1 == ::sigaction(stackSignal(), &sa, nullptr)) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot install stack snapshot signal handler: <"
+                  << e.what() << ">.";
+        throw e;
+    }
+
+    installed = true;
+}
+
+/** Sends stack request signal to given thread, returns errno on failure.
+ */
+int signalThread(::pid_t pid, ::pid_t tid)
+{
+    if (-1 == ::syscall(SYS_tgkill, pid, tid, stackSignal())) {
+        return errno;
+    }
+    return 0;
+}
+
+#else // !__linux__
+
+// threads cannot be signalled by registry id, only own stack is available
+void install() {}
+
+int signalThread(::pid_t, ::pid_t) { return ENOSYS; }
+
+#endif // __linux__
+
+} // namespace
+
+void printStacks(std::ostream &os, std::chrono::milliseconds timeout)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    install();
+
+    const auto threads(registeredThreads());
+    const auto count(std::min(threads.size(), MaxThreads));
+    const auto pid(::getpid());
+    const auto self(currentThreadId());
+
+    // errno of failed signal delivery per thread
+    std::vector<int> errors(count);
+
+    for (std::size_t i(0); i < count; ++i) {
+        auto &slot(slots[i]);
+        slot.depth = 0;
+        slot.tid.store(threads[i].tid, std::memory_order_release);
+
+        if (threads[i].tid == self) {
+            slot.depth = ::backtrace(slot.frames, MaxDepth);
+            slot.state = done;
+            continue;
+        }
+
+        slot.state = requested;
+        if ((errors[i] = signalThread(pid, threads[i].tid))) {
+            slot.state = idle;
+        }
+    }
+
+    const auto pending([&]() -> bool {
+        for (std::size_t i(0); i < count; ++i) {
+            const auto state(slots[i].state.load());
+            if ((state == requested) || (state == capturing)) { return true; }
+        }
+        return false;
+    });
+
+    const auto deadline(std::chrono::steady_clock::now() + timeout);
+    while (pending() && (std::chrono::steady_clock::now() < deadline)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // revoke unanswered requests; wait for captures already in progress
+    for (std::size_t i(0); i < count; ++i) {
+        auto &slot(slots[i]);
+        int expected(requested);
+        if (slot.state.compare_exchange_strong(expected, idle)) { continue; }
+        while (slot.state.load(std::memory_order_acquire) == capturing) {
+            std::this_thread::yield();
+        }
+    }
+
+    Symbolizer symbolize;
+    for (std::size_t i(0); i < count; ++i) {
+        auto &slot(slots[i]);
+        const auto &thread(threads[i]);
+
+        os << "Thread " << thread.tid << " " << thread.name;
+        if (!thread.role.empty()) { os << " (" << thread.role << ")"; }
+        os << ":\n";
+
+        if (slot.state.load(std::memory_order_acquire) == done) {
+            // own stack has no signal frames, only this function's one
+            const int skip((thread.tid == self) ? 1 : SkipFrames);
+            for (int f(skip); f < slot.depth; ++f) {
+                os << "    #" << (f - skip) << " " << slot.frames[f]
+                   << " " << symbolize(slot.frames[f]) << "\n";
+            }
+        } else if (errors[i]) {
+            os << "    <cannot signal thread: "
+               << std::system_category().message(errors[i]) << ">\n";
+        } else {
+            os << "    <no response in " << timeout.count() << " ms>\n";
+        }
+
+        slot.state = idle;
+        slot.tid = 0;
+    }
+
+    if (threads.size() > count) {
+        os << "(" << (threads.size() - count) << " more threads omitted)\n";
+    }
+}
+
+} } // namespace service::detail
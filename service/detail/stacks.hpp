@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_detail_stacks_hpp_included_
+#define shared_service_detail_stacks_hpp_included_
+
+#include <chrono>
+#include <ostream>
+
+namespace service { namespace detail {
+
+/** Prints stack traces of all registered threads (see registerThread()).
+ *
+ *  Each thread is interrupted by a real-time signal (SIGRTMIN + 4) and
+ *  records its own backtrace into a preallocated slot; the caller waits at
+ *  most given timeout for all of them. Threads that do not respond in time
+ *  (signal blocked, uninterruptible sleep) are reported as such. Stack of
+ *  the calling thread is captured directly.
+ *
+ *  Signal handler is installed on first use and kept afterwards since a late
+ *  signal would otherwise kill the process. Interrupted blocking calls are
+ *  restarted (SA_RESTART) where the kernel allows it.
+ *
+ *  Other threads can be signalled only on Linux; elsewhere just the stack of
+ *  the calling thread is printed.
+ *
+ *  Concurrent calls are serialized.
+ */
+void printStacks(std::ostream &os, std::chrono::milliseconds timeout);
+
+} } // namespace service::detail
+
+#endif // shared_service_detail_stacks_hpp_included_
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dlfcn.h>
+#include <cxxabi.h>
+
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+
+#include <boost/filesystem/path.hpp>
+
+#include "symbolizer.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace service { namespace detail {
+
+namespace {
+
+std::string demangle(const char *name)
+{
+    int status(0);
+    std::unique_ptr<char, decltype(&std::free)>
+        d(abi::__cxa_demangle(name, nullptr, nullptr, &status), &std::free);
+    return (!status && d) ? std::string(d.get()) : std::string(name);
+}
+
+} // namespace
+
+const std::string& Symbolizer::operator()(void *address)
+{
+    auto fcache(cache_.find(address));
+    if (fcache != cache_.end()) { return fcache->second; }
+
+    std::string name;
+    ::Dl_info info{};
+    const auto found(::dladdr(address, &info));
+    if (found && info.dli_sname) {
+        name = demangle(info.dli_sname);
+    } else if (found && info.dli_fname) {
+        std::ostringstream os;
+        os << fs::path(info.dli_fname).filename().string() << "+0x"
+           << std::hex
+           << (static_cast<char*>(address)
+               - static_cast<char*>(info.dli_fbase));
+        name = os.str();
+    } else {
+        std::ostringstream os;
+        os << address;
+        name = os.str();
+    }
+
+    return cache_.insert(std::make_pair(address, name)).first->second;
+}
+
+} } // namespace service::detail
@@ -0,0 +1,319 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <condition_variable>
+
+#include "dbglog/dbglog.hpp"
+
+#include "executor.hpp"
+#include "threadregistry.hpp"
+
+namespace service {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/** Pool and index of calling thread (if a pool thread).
+ */
+thread_local const Executor::Detail *currentPool(nullptr);
+thread_local unsigned int currentIndex(0);
+
+} // namespace
+
+struct Executor::Detail {
+    struct Item {
+        Task task;
+        Clock::time_point queued;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Item> items;
+    };
+
+    Detail(const std::string &name, unsigned int threads);
+
+    bool post(Task &&task);
+    void cancel();
+    void stop();
+
+    void run(unsigned int index);
+    bool pop(unsigned int index, Item &item);
+    bool steal(unsigned int index, Item &item);
+    void execute(Item &item);
+    std::size_t drain();
+
+    const std::string name;
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> threads;
+
+    std::atomic<bool> cancelled;
+
+    /** Number of tasks in all queues; incremented/decremented under queue
+     *  lock when a task is added/taken.
+     */
+    std::atomic<std::size_t> pending;
+
+    std::mutex idleMutex;
+    std::condition_variable idleCond;
+    std::atomic<unsigned int> idle;
+
+    std::atomic<unsigned int> next;
+
+    // statistics
+    std::atomic<std::uint64_t> executed;
+    std::atomic<std::uint64_t> stolen;
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<std::uint64_t> failed;
+    std::atomic<std::uint64_t> latencySum;
+    std::atomic<std::uint64_t> latencyMax;
+};
+
+Executor::Detail::Detail(const std::string &name, unsigned int threads)
+    : name(name), cancelled(false), pending(0), idle(0), next(0)
+    , executed(0), stolen(0), dropped(0), failed(0)
+    , latencySum(0), latencyMax(0)
+{
+    if (!threads) { threads = 1; }
+
+    for (unsigned int i(0); i < threads; ++i) {
+        queues.emplace_back(new Queue());
+    }
+
+    for (unsigned int i(0); i < threads; ++i) {
+        this->threads.emplace_back(&Detail::run, this, i);
+    }
+
+    LOG(info2) << "Executor <" << name << "> started with "
+               << threads << " threads.";
+}
+
+bool Executor::Detail::post(Task &&task)
+{
+    if (cancelled) { return false; }
+
+    const auto index((currentPool == this)
+                     ? currentIndex
+                     : (next++ % queues.size()));
+    {
+        auto &queue(*queues[index]);
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        queue.items.push_back(Item{std::move(task), Clock::now()});
+
+        // counted under queue lock: pop()/steal() decrement under the same
+        // lock only after taking the item, so pending never goes below zero
+        ++pending;
+    }
+
+    // pending must be incremented before idle is checked (idle thread
+    // increments idle before checking pending)
+    if (idle) {
+        std::lock_guard<std::mutex> guard(idleMutex);
+        idleCond.notify_one();
+    }
+    return true;
+}
+
+bool Executor::Detail::pop(unsigned int index, Item &item)
+{
+    auto &queue(*queues[index]);
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    if (queue.items.empty()) { return false; }
+    item = std::move(queue.items.back());
+    queue.items.pop_back();
+    --pending;
+    return true;
+}
+
+bool Executor::Detail::steal(unsigned int index, Item &item)
+{
+    for (std::size_t i(1); i < queues.size(); ++i) {
+        auto &queue(*queues[(index + i) % queues.size()]);
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        if (queue.items.empty()) { continue; }
+        item = std::move(queue.items.front());
+        queue.items.pop_front();
+        --pending;
+        ++stolen;
+        return true;
+    }
+    return false;
+}
+
+void Executor::Detail::execute(Item &item)
+{
+    const std::uint64_t latency
+        (std::chrono::duration_cast<std::chrono::microseconds>
+         (Clock::now() - item.queued).count());
+    latencySum += latency;
+    auto max(latencyMax.load());
+    while ((latency > max)
+           && !latencyMax.compare_exchange_weak(max, latency)) {}
+
+    try {
+        item.task();
+    } catch (const std::exception &e) {
+        ++failed;
+        LOG(err2) << "Executor <" << name << ">: task failed: <"
+                  << e.what() << ">.";
+    } catch (...) {
+        ++failed;
+        LOG(err2) << "Executor <" << name << ">: task failed.";
+    }
+    ++executed;
+
+    // release captured resources before going idle
+    item.task = Task();
+}
+
+void Executor::Detail::run(unsigned int index)
+{
+    auto registration(registerThread(name + std::to_string(index), name));
+    currentPool = this;
+    currentIndex = index;
+
+    Item item;
+    while (!cancelled) {
+        if (pop(index, item) || steal(index, item)) {
+            execute(item);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex);
+        ++idle;
+        idleCond.wait(lock, [this]() { return cancelled || pending; });
+        --idle;
+    }
+
+    currentPool = nullptr;
+}
+
+std::size_t Executor::Detail::drain()
+{
+    std::size_t count(0);
+    for (auto &queue : queues) {
+        std::deque<Item> items;
+        {
+            std::lock_guard<std::mutex> guard(queue->mutex);
+            std::swap(items, queue->items);
+            pending -= items.size();
+        }
+        count += items.size();
+    }
+    dropped += count;
+    return count;
+}
+
+void Executor::Detail::cancel()
+{
+    if (cancelled.exchange(true)) { return; }
+
+    if (const auto count = drain()) {
+        LOG(info2) << "Executor <" << name << ">: cancelled "
+                   << count << " queued tasks.";
+    }
+
+    std::lock_guard<std::mutex> guard(idleMutex);
+    idleCond.notify_all();
+}
+
+void Executor::Detail::stop()
+{
+    if (currentPool == this) {
+        LOGTHROW(err2, std::logic_error)
+            << "Executor <" << name << "> cannot be stopped from "
+            "its own thread.";
+    }
+
+    cancel();
+    for (auto &thread : threads) {
+        if (thread.joinable()) { thread.join(); }
+    }
+
+    // tasks posted while cancelling
+    drain();
+}
+
+Executor::Executor(const std::string &name, unsigned int threads)
+    : detail_(new Detail(name, threads))
+{}
+
+Executor::~Executor()
+{
+    if (detail_) { detail().stop(); }
+}
+
+bool Executor::post(Task task)
+{
+    return detail().post(std::move(task));
+}
+
+void Executor::cancel()
+{
+    detail().cancel();
+}
+
+void Executor::stop()
+{
+    detail().stop();
+}
+
+unsigned int Executor::size() const
+{
+    return detail().queues.size();
+}
+
+void Executor::stat(std::ostream &os, const std::string &prefix) const
+{
+    const auto &d(detail());
+
+    os << prefix << "Threads: " << d.queues.size()
+       << "\n" << prefix << "Queued: " << d.pending << " (";
+    bool first(true);
+    for (const auto &queue : d.queues) {
+        if (first) { first = false; } else { os << ' '; }
+        std::lock_guard<std::mutex> guard(queue->mutex);
+        os << queue->items.size();
+    }
+
+    const std::uint64_t executed(d.executed);
+    os << ")\n" << prefix << "Executed: " << executed
+       << "\n" << prefix << "Stolen: " << d.stolen
+       << "\n" << prefix << "Failed: " << d.failed
+       << "\n" << prefix << "Cancelled: " << d.dropped
+       << "\n" << prefix << "Latency: avg "
+       << (executed ? (d.latencySum / executed) : 0)
+       << " us, max " << d.latencyMax << " us\n";
+}
+
+} // namespace service
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_executor_hpp_included_
+#define service_executor_hpp_included_
+
+#include <string>
+#include <memory>
+#include <ostream>
+#include <functional>
+
+namespace service {
+
+/** Work-stealing thread pool.
+ *
+ *  Every thread owns a deque: tasks posted from a pool thread go to its own
+ *  deque and are run LIFO (cache-friendly), tasks posted from outside are
+ *  distributed round-robin. Idle threads steal the oldest task from other
+ *  deques before going to sleep.
+ *
+ *  Threads are registered (see registerThread()) as "<name><index>" with
+ *  role <name>.
+ */
+class Executor {
+public:
+    typedef std::function<void()> Task;
+
+    /** Zero thread count means one thread.
+     */
+    Executor(const std::string &name, unsigned int threads);
+
+    /** Stops the pool, see stop().
+     */
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /** Queues task for execution. Exceptions thrown by the task are logged
+     *  and otherwise ignored.
+     *
+     *  Returns false (and drops the task) when the pool has been cancelled.
+     */
+    bool post(Task task);
+
+    /** Drops all queued tasks and makes threads exit after their current
+     *  task. Does not wait; safe to call from any thread, including pool
+     *  threads.
+     */
+    void cancel();
+
+    /** Cancels the pool and joins all threads. Must not be called from a
+     *  pool thread.
+     */
+    void stop();
+
+    /** Number of threads.
+     */
+    unsigned int size() const;
+
+    /** Prints queue depth, executed/stolen/cancelled task counts and task
+     *  latency (time spent in queue), one "Key: value" per line prefixed
+     *  with given prefix.
+     */
+    void stat(std::ostream &os, const std::string &prefix = "Executor-")
+        const;
+
+    struct Detail;
+
+private:
+    std::unique_ptr<Detail> detail_;
+    Detail& detail() { return *detail_; }
+    const Detail& detail() const { return *detail_; }
+};
+
+} // namespace service
+
+#endif // service_executor_hpp_included_
@@ -52,21 +52,50 @@ struct NetCtrlClient::Detail {
     Detail(const utility::TcpEndpoint &endpoint
            , const std::string &component
            , const std::string &secret)
-        : endpoint(endpoint)
-        , ctrl(boost::lexical_cast<std::string>(endpoint), endpoint.value
-               , component)
+        : endpoint(endpoint), name(boost::lexical_cast<std::string>(endpoint))
         , component(component), secret(secret)
     {
-        const auto challenge(command(component).front());
-        command(ctrlResponse(challenge, secret));
+        connect();
+    }
+
+    void connect() {
+        ctrl.reset(new detail::CtrlClient<tcp>(name, endpoint.value
+                                               , component));
+
+        CtrlClientHandshake hs(component, secret
+                               , detail::ctrlSessionPeer(endpoint.value));
+        try {
+            auto line(hs.start());
+            while (auto next = hs.next(command(line))) { line = *next; }
+        } catch (...) {
+            // stale session (e.g. server restarted) -> full handshake
+            if (!hs.failed()) { throw; }
+            LOG(info2) << "Session resumption with <" << name
+                       << "> failed, retrying with full handshake.";
+            connect();
+        }
     }
 
     CtrlClientBase::Result command(const std::string &command) {
-        return ctrl.command(command);
+        return ctrl->command(command);
     }
 
+    CtrlResponse commandResponse(const std::string &command) {
+        return ctrl->commandResponse(command);
+    }
+
+    void pipeline(const std::vector<std::string> &commands
+                  , std::size_t depth
+                  , const PipelineCallback &callback)
+    {
+        ctrl->pipeline(commands, depth, callback);
+    }
+
+    bool alive() { return ctrl->alive(); }
+
     utility::TcpEndpoint endpoint;
-    detail::CtrlClient<tcp> ctrl;
+    const std::string name;
+    std::unique_ptr<detail::CtrlClient<tcp> > ctrl;
     const std::string component;
     const std::string secret;
 };
@@ -98,7 +127,24 @@ NetCtrlClient::Params::Params(const std::string &uri)
 
 CtrlClientBase::Result NetCtrlClient::command(const std::string &command)
 {
-    return detail().command(command);
+    return detail().commandResponse(command).lines();
+}
+
+CtrlResponse NetCtrlClient::commandResponse(const std::string &command)
+{
+    return detail().commandResponse(command);
+}
+
+void NetCtrlClient::pipeline(const std::vector<std::string> &commands
+                             , std::size_t depth
+                             , const PipelineCallback &callback)
+{
+    detail().pipeline(commands, depth, callback);
+}
+
+bool NetCtrlClient::alive()
+{
+    return detail().alive();
 }
 
 } // namespace service
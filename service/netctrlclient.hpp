@@ -70,6 +70,14 @@ public:
      */
     Result command(const std::string &command) override;
 
+    CtrlResponse commandResponse(const std::string &command) override;
+
+    void pipeline(const std::vector<std::string> &commands
+                  , std::size_t depth
+                  , const PipelineCallback &callback) override;
+
+    bool alive() override;
+
     struct Detail;
 
     static constexpr const int DefaultPort = 2020;
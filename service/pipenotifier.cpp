@@ -25,8 +25,11 @@
  */
 
 #include <system_error>
+#include <cstring>
 
 #include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
 
 #include <dbglog/dbglog.hpp>
 
@@ -34,75 +37,252 @@
 
 namespace service {
 
+namespace {
+
+struct Header {
+    std::uint32_t size;
+    std::uint32_t type;
+};
+
+const std::size_t ReadChunk(1 << 16);
+
+void systemError(const char *what)
+{
+    std::system_error e(errno, std::system_category());
+    LOG(err2) << what << ": <" << e.what() << ">.";
+    throw e;
+}
+
+} // namespace
+
+constexpr std::size_t PipeNotifier::MaxMessageSize;
+
 PipeNotifier::PipeNotifier(utility::Runnable &runnable)
-    : runnable_(runnable), fd_{ -1, -1 }
+    : runnable_(runnable)
 {
-    // direct I/O -> writes should send whole packets
-    if (-1 == ::pipe2(fd_, O_DIRECT)) {
-        std::system_error e(errno, std::system_category());
-        LOG(err2) << "Failed to create notifier pipe: <" << e.what() << ">.";
-        throw e;
+    int fd[2];
+    if (-1 == ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC
+                           , 0, fd))
+    {
+        systemError("Failed to create notifier socket pair");
     }
+
+    side(Role::master).fd = fd[0];
+    side(Role::slave).fd = fd[1];
 }
 
 PipeNotifier::~PipeNotifier()
 {
-    for (auto fd : fd_) {
-        if (fd >= 0) { ::close(fd); }
+    for (auto &side : sides_) {
+        if (side.fd >= 0) { ::close(side.fd); }
     }
 }
 
-std::string PipeNotifier::master()
+int PipeNotifier::fd(Role role) const
+{
+    return side(role).fd;
+}
+
+void PipeNotifier::detach(Role role)
+{
+    auto &other(side((role == Role::master) ? Role::slave : Role::master));
+    if (other.fd >= 0) {
+        ::close(other.fd);
+        other.fd = -1;
+    }
+
+    side(role).writer = ::getpid();
+}
+
+std::size_t PipeNotifier::queued(Role from) const
+{
+    const auto &s(side(from));
+    return s.out.size() - s.outOffset;
+}
+
+bool PipeNotifier::send(Role from, const Message &message)
+{
+    if (message.data.size() > MaxMessageSize) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Notification message too large (" << message.data.size()
+            << " > " << MaxMessageSize << ").";
+    }
+
+    auto &s(side(from));
+
+    const auto self(::getpid());
+    if (!s.writer) {
+        s.writer = self;
+    } else if (s.writer != self) {
+        LOGTHROW(err2, std::logic_error)
+            << "Notification pipe side already written by process "
+            << s.writer << "; only a single writer is allowed.";
+    }
+
+    const Header header{ std::uint32_t(message.data.size()), message.type };
+    s.out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    s.out.append(message.data);
+
+    write(s);
+    return s.out.empty();
+}
+
+void PipeNotifier::write(Side &s)
+{
+    while (s.outOffset < s.out.size()) {
+        auto w(::send(s.fd, s.out.data() + s.outOffset
+                      , s.out.size() - s.outOffset, MSG_NOSIGNAL));
+        if (-1 == w) {
+            if (EINTR == errno) {
+                if (!runnable_.isRunning()) {
+                    LOGTHROW(err2, std::runtime_error)
+                        << "Interrupted while writing to notification pipe.";
+                }
+                continue;
+            }
+            if ((EAGAIN == errno) || (EWOULDBLOCK == errno)) { break; }
+            systemError("Error writing to notification pipe");
+        }
+
+        s.outOffset += w;
+    }
+
+    if (s.outOffset == s.out.size()) {
+        s.out.clear();
+        s.outOffset = 0;
+    }
+}
+
+bool PipeNotifier::wait(const Side &s, short events
+                        , const boost::optional
+                        <std::chrono::steady_clock::time_point> &deadline)
 {
-    char buffer[PIPE_BUF];
     for (;;) {
-        auto r(::read(fd_[0], buffer, sizeof(buffer)));
+        int timeout(-1);
+        if (deadline) {
+            auto remaining(std::chrono::duration_cast<std::chrono::milliseconds>
+                           (*deadline - std::chrono::steady_clock::now()));
+            timeout = std::max(0, int(remaining.count()));
+        }
+
+        ::pollfd pfd{ s.fd, events, 0 };
+        auto r(::poll(&pfd, 1, timeout));
         if (-1 == r) {
             if (EINTR == errno) {
                 if (!runnable_.isRunning()) {
                     LOGTHROW(err2, std::runtime_error)
-                        << "Interrupted while writing to notification pipe.";
+                        << "Interrupted while waiting for notification pipe.";
                 }
                 continue;
-            } else {
-                std::system_error e(errno, std::system_category());
-                LOG(err2) << "Error writing to notification pipe: <"
-                          << e.what() << ">.";
-                throw e;
             }
+            systemError("Error polling notification pipe");
         }
 
-        return std::string(buffer, r);
+        return r > 0;
     }
 }
 
-void PipeNotifier::slave(const std::string &string)
+namespace {
+
+boost::optional<std::chrono::steady_clock::time_point>
+deadline(PipeNotifier::Timeout timeout)
 {
-    if (string.size() > PIPE_BUF) {
-        LOGTHROW(err2, std::runtime_error)
-            << "Notification string too large (" << string.size()
-            << " > PIPE_BUF(" << PIPE_BUF << ").";
+    if (timeout.count() < 0) { return boost::none; }
+    return std::chrono::steady_clock::now() + timeout;
+}
+
+} // namespace
+
+bool PipeNotifier::flush(Role from, Timeout timeout)
+{
+    auto &s(side(from));
+    const auto dl(deadline(timeout));
+
+    for (;;) {
+        write(s);
+        if (s.out.empty()) { return true; }
+        if (!wait(s, POLLOUT, dl)) { return false; }
     }
+}
+
+boost::optional<PipeNotifier::Message>
+PipeNotifier::receive(Role to, Timeout timeout)
+{
+    auto &s(side(to));
+    const auto dl(deadline(timeout));
 
     for (;;) {
-        auto w(::write(fd_[1], string.data(), string.size()));
-        if (-1 == w) {
+        // complete message in the buffer?
+        const auto available(s.in.size() - s.inOffset);
+        if (available >= sizeof(Header)) {
+            const auto *data(s.in.data() + s.inOffset);
+            Header header;
+            std::memcpy(&header, data, sizeof(header));
+            if (header.size > MaxMessageSize) {
+                LOGTHROW(err2, std::runtime_error)
+                    << "Invalid notification message size ("
+                    << header.size << ").";
+            }
+
+            const auto total(sizeof(Header) + header.size);
+            if (available >= total) {
+                Message message(header.type
+                                , std::string(data + sizeof(Header)
+                                              , header.size));
+                s.inOffset += total;
+                return message;
+            }
+        }
+
+        // drop consumed messages once per read, not once per message
+        if (s.inOffset) {
+            s.in.erase(0, s.inOffset);
+            s.inOffset = 0;
+        }
+
+        // read whatever is available
+        const auto size(s.in.size());
+        s.in.resize(size + ReadChunk);
+        auto r(::recv(s.fd, &s.in[size], ReadChunk, 0));
+        const auto error(errno);
+        s.in.resize(size + std::max(0, int(r)));
+
+        if (!r) {
+            throw Closed("Notification pipe closed by peer.");
+        }
+
+        if (-1 == r) {
+            errno = error;
             if (EINTR == errno) {
                 if (!runnable_.isRunning()) {
                     LOGTHROW(err2, std::runtime_error)
-                        << "Interrupted while writing to notification pipe.";
+                        << "Interrupted while reading from notification "
+                        "pipe.";
                 }
                 continue;
-            } else {
-                std::system_error e(errno, std::system_category());
-                LOG(err2) << "Error writing to notification pipe: <"
-                          << e.what() << ">.";
-                throw e;
             }
+            if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) {
+                systemError("Error reading from notification pipe");
+            }
+
+            if (!wait(s, POLLIN, dl)) { return boost::none; }
         }
+    }
+}
 
-        break;
+std::string PipeNotifier::master()
+{
+    try {
+        return receive(Role::master)->data;
+    } catch (const Closed&) {
+        return {};
     }
 }
 
+void PipeNotifier::slave(const std::string &string)
+{
+    send(Role::slave, Message(0, string));
+    flush(Role::slave);
+}
+
 } // namespace service
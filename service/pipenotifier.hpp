@@ -27,30 +27,141 @@
 #ifndef service_pipenotifier_hpp_included_
 #define service_pipenotifier_hpp_included_
 
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+#include <sys/types.h>
+
+#include <boost/optional.hpp>
+
 #include "utility/runnable.hpp"
 
 namespace service {
 
+/** Bidirectional framed message channel between processes sharing this
+ *  object over fork (built on socketpair).
+ *
+ *  Each message is prefixed with {u32 size, u32 type} header, therefore
+ *  messages can be of any size. Sending never blocks: unsent data are queued
+ *  and written by subsequent send()/flush() calls. Receiving waits at most
+ *  given timeout.
+ *
+ *  Each process uses only its own side (role); state of the object is
+ *  per-process after fork.
+ *
+ *  Each side must have a single writer: the byte stream carries no
+ *  per-message atomicity, so two processes sending through the same side
+ *  (e.g. several forked children sharing the slave side) would interleave
+ *  their frames. The first process that sends through a side (or claims it
+ *  by detach()) owns it; send() from any other process throws
+ *  std::logic_error. Use one PipeNotifier per child when several children
+ *  need to talk to the master.
+ */
 class PipeNotifier {
 public:
+    enum class Role { master, slave };
+
+    struct Message {
+        std::uint32_t type;
+        std::string data;
+
+        Message(std::uint32_t type = 0, const std::string &data = std::string())
+            : type(type), data(data)
+        {}
+    };
+
+    /** Thrown by receive() when the other side has been closed.
+     */
+    struct Closed : std::runtime_error {
+        Closed(const std::string &msg) : std::runtime_error(msg) {}
+    };
+
+    /** Negative timeout means wait forever.
+     */
+    typedef std::chrono::milliseconds Timeout;
+
+    static constexpr std::size_t MaxMessageSize = 1 << 30;
+
     PipeNotifier(utility::Runnable &runnable);
 
     ~PipeNotifier();
 
+    PipeNotifier(const PipeNotifier&) = delete;
+    PipeNotifier& operator=(const PipeNotifier&) = delete;
+
+    /** Sends message from given side. Writes as much as possible without
+     *  blocking, the rest is queued.
+     *
+     *  Returns true if nothing is left in the queue.
+     */
+    bool send(Role from, const Message &message);
+
+    /** Writes queued data, waits at most given timeout.
+     *
+     *  Returns true if nothing is left in the queue.
+     */
+    bool flush(Role from, Timeout timeout = Timeout(-1));
+
+    /** Number of queued (unsent) bytes.
+     */
+    std::size_t queued(Role from) const;
+
+    /** Receives message sent to given side, waits at most given timeout.
+     *
+     *  Returns none on timeout, throws Closed when the other side is closed.
+     */
+    boost::optional<Message> receive(Role to, Timeout timeout = Timeout(-1));
+
+    /** File descriptor of given side, usable in poll/asio.
+     */
+    int fd(Role role) const;
+
+    /** Closes the other side in this process and makes this process the
+     *  writer of given side. Should be called after fork so that receive()
+     *  can detect that the peer is gone.
+     */
+    void detach(Role role);
+
     /** Reads a string from the slave.
-     *  TODO: add read timeout
+     *  Returns empty string when slave side is closed.
      *  NB: Must be called in different process than slave(line)
      */
     std::string master();
 
-    /** Writes a string to the master.
+    /** Writes a string to the master, blocks until written.
      *  NB: Must be called in different process than master()
      */
     void slave(const std::string &string);
 
 private:
+    struct Side {
+        int fd;
+        std::string out;
+        std::size_t outOffset;
+        std::string in;
+        std::size_t inOffset;
+
+        /** Process writing through this side, 0 = not claimed yet.
+         */
+        ::pid_t writer;
+
+        Side() : fd(-1), outOffset(), inOffset(), writer() {}
+    };
+
+    Side& side(Role role) { return sides_[static_cast<int>(role)]; }
+    const Side& side(Role role) const {
+        return sides_[static_cast<int>(role)];
+    }
+
+    void write(Side &side);
+    bool wait(const Side &side, short events
+              , const boost::optional<std::chrono::steady_clock::time_point>
+              &deadline);
+
     utility::Runnable &runnable_;
-    int fd_[2];
+    Side sides_[2];
 };
 
 } // namespace service
@@ -28,17 +28,17 @@
 
 #include <cerrno>
 #include <cstdlib>
+#include <cctype>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <set>
 #include <clocale>
+#include <system_error>
 
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/utility/in_place_factory.hpp>
-#include <boost/tokenizer.hpp>
-#include <boost/token_functions.hpp>
 
 #include "utility/buildsys.hpp"
 #include "utility/path.hpp"
@@ -47,6 +47,8 @@
 #include "buildtimestamp.hpp"
 
 #include "program.hpp"
+#include "detail/mappedfile.hpp"
+#include "detail/responsefile.hpp"
 
 #ifdef BUILDSYS_CUSTOMER_BUILD
 #define LOCAL_BUILDSYS_CUSTOMER_INFO " for " BUILDSYS_CUSTOMER
@@ -114,26 +116,60 @@ void setCLocale()
 
 #endif
 
-void add(UnrecognizedOptions &un
-         , const po::basic_parsed_options<char> &parsed)
+/** Finds line of first occurrence of each key in config file content.
+ *  Follows boost::program_options config file syntax: '#' comments,
+ *  [section] prefixes and name = value pairs.
+ */
+std::unordered_map<std::string, unsigned int>
+configLines(boost::string_view content)
 {
-    UnrecognizedOptions::ConfigOptions opts;
-    for (const auto &opt : parsed.options) {
-        if (!opt.unregistered) { continue; }
-        for (auto iot(opt.original_tokens.begin())
-                 , eot(opt.original_tokens.end());
-             iot != eot; ++iot)
-        {
-            auto key(*iot++);
-            opts[key].push_back(*iot);
-            un.seenConfigKeys.push_back(key);
+    std::unordered_map<std::string, unsigned int> lines;
+
+    const auto trim([](const char *b, const char *e) -> std::string {
+        while ((b != e) && std::isspace(static_cast<unsigned char>(*b))) {
+            ++b;
         }
-    }
+        while ((e != b)
+               && std::isspace(static_cast<unsigned char>(e[-1]))) {
+            --e;
+        }
+        return std::string(b, e);
+    });
 
-    // add only if non-empty
-    if (!opts.empty()) {
-        un.config.push_back(opts);
+    std::string prefix;
+    unsigned int lineNo(0);
+    for (auto b(content.data()), end(b + content.size()); b < end; ) {
+        auto e(static_cast<const char*>
+               (std::memchr(b, '\n', end - b)));
+        if (!e) { e = end; }
+        ++lineNo;
+
+        auto line(trim(b, e));
+        b = e + 1;
+
+        const auto comment(line.find('#'));
+        if (comment != std::string::npos) {
+            line = trim(line.data(), line.data() + comment);
+        }
+        if (line.empty()) { continue; }
+
+        if ((line.front() == '[') && (line.back() == ']')) {
+            // same as boost: section name is taken verbatim
+            prefix = line.substr(1, line.size() - 2);
+            if (prefix.empty() || (prefix.back() != '.')) {
+                prefix.push_back('.');
+            }
+            continue;
+        }
+
+        const auto eq(line.find('='));
+        if (eq == std::string::npos) { continue; }
+        lines.insert(std::make_pair
+                     (prefix + trim(line.data(), line.data() + eq)
+                      , lineNo));
     }
+
+    return lines;
 }
 
 } // namespace
@@ -253,36 +289,30 @@ const char *EXTRA_OPTIONS = "\n";
 typedef std::vector<std::string> Strings;
 typedef std::vector<boost::filesystem::path> Files;
 
-Strings parseResponseFiles(const Files &files, std::vector<std::stringstream> & dumpOutput)
+Strings parseResponseFiles(const Files &files, int flags
+                           , std::vector<std::stringstream> & dumpOutput)
 {
-    Strings args;
-
-    for (const auto &file: files) {
-        std::ifstream is(file.c_str());
-        if (!is) {
-            std::cerr
-                << "Unable to read response file " << file << "."
-                << std::endl;
-            immediateExit(EXIT_FAILURE);
-        }
-
-        typedef boost::char_separator<char> Separator;
-        typedef std::istreambuf_iterator<char> Iterator;
-        typedef boost::tokenizer<Separator, Iterator> Tokenizer;
-
-        Separator separator(" \n\r");
-        Tokenizer tokenizer(Iterator(is), Iterator(), separator);
-
-        std::copy(tokenizer.begin(), tokenizer.end()
-                  , std::back_inserter(args));
-
-        is.clear(); // clear fail and eof bits
-        is.seekg(0, std::ios_base::beg); // seek to begin
+    detail::ResponseFileReader reader
+        ((flags & ENABLE_SHELL_RESPONSE_FILES)
+         ? detail::ResponseFileReader::Syntax::shell
+         : detail::ResponseFileReader::Syntax::plain
+         , [&](const boost::filesystem::path &file, boost::string_view content)
+    {
         dumpOutput.emplace_back();
-        dumpOutput.back() << "Loaded response file from " << file << ", contents:" << std::endl << is.rdbuf() << std::endl;
+        auto &os(dumpOutput.back());
+        os << "Loaded response file from " << file << ", contents:" << std::endl;
+        os.write(content.data(), content.size());
+        os << std::endl;
+    });
+
+    try {
+        for (const auto &file: files) { reader.read(file); }
+    } catch (const detail::ResponseFileError &e) {
+        std::cerr << e.what() << std::endl;
+        immediateExit(EXIT_FAILURE);
     }
 
-    return args;
+    return std::move(reader.args());
 }
 
 template <typename ...Args>
@@ -450,7 +480,8 @@ Program::configureImpl(int argc, char *argv[]
 
     if (vm.count("response-file")) {
         // parse response file as a cmdline, ignore response file
-        const auto args(parseResponseFiles(vm["response-file"].as<Files>(), dumpOutput));
+        const auto args(parseResponseFiles
+                        (vm["response-file"].as<Files>(), flags_, dumpOutput));
         parse(createParser(all, positionals, flags_, {}, args));
     }
 
@@ -561,30 +592,31 @@ Program::configureImpl(int argc, char *argv[]
         configs.add(genericConfig).add(config);
 
         for (const auto &cfg : cfgs) {
-            std::ifstream f;
-            f.exceptions(std::ifstream::failbit | std::ifstream::badbit);
             try {
-                f.open(cfg.c_str());
-                f.exceptions(std::ifstream::badbit);
-                auto parsed(po::parse_config_file(f, configs
+                // map whole file once: parsed, dumped and used to locate
+                // unrecognized options
+                const detail::MappedFile file(cfg);
+                detail::MemoryStreamBuf buf(file.content());
+                std::istream is(&buf);
+                auto parsed(po::parse_config_file(is, configs
                             , flags_ & ENABLE_CONFIG_UNRECOGNIZED_OPTIONS));
                 store(parsed, vm);
 
                 if (flags_ & ENABLE_CONFIG_UNRECOGNIZED_OPTIONS) {
-                    add(un, parsed);
+                    un.add(parsed, cfg, file.content());
                 }
 
-                f.clear(); // clear fail and eof bits
-                f.seekg(0, std::ios_base::beg); // seek to begin
                 if (dumpConfig) {
                     dumpOutput.emplace_back();
-                    dumpOutput.back() << "Loaded configuration from " << cfg << ", contents:" << std::endl << f.rdbuf() << std::endl;
+                    auto &os(dumpOutput.back());
+                    os << "Loaded configuration from " << cfg << ", contents:" << std::endl;
+                    os.write(file.data(), file.size());
+                    os << std::endl;
                 } else {
                     // Warning, logging before log.mask, log.file, etc. is set!
                     LOG(info3) << "Loaded configuration from " << cfg << ".";
                 }
-                f.close();
-            } catch(const std::ios_base::failure &e) {
+            } catch (const std::system_error &e) {
                 LOG(fatal) << "Cannot read config file " << cfg << ": "
                            << e.what();
                 immediateExit(EXIT_FAILURE);
@@ -728,48 +760,91 @@ Program::configureImpl(int argc, char *argv[]
     return vm;
 }
 
-UnrecognizedOptions::Keys UnrecognizedOptions::configKeys() const
+void UnrecognizedOptions::add(const po::parsed_options &parsed
+                              , const boost::filesystem::path &file
+                              , boost::string_view content)
 {
-    Keys k;
-    for (const auto &co : config) {
-        for (const auto &item : co) {
-            k.insert(item.first);
+    ConfigOptions opts;
+    for (const auto &opt : parsed.options) {
+        if (!opt.unregistered) { continue; }
+        for (auto iot(opt.original_tokens.begin())
+                 , eot(opt.original_tokens.end());
+             iot != eot; ++iot)
+        {
+            auto key(*iot++);
+            opts[key].push_back(*iot);
+            seenConfigKeys.push_back(key);
         }
     }
+
+    // add only if non-empty
+    if (opts.empty()) { return; }
+
+    const auto lines(content.empty()
+                     ? std::unordered_map<std::string, unsigned int>()
+                     : configLines(content));
+
+    // index: first occurrence wins
+    const auto fileIndex(config.size());
+    index_.reserve(index_.size() + opts.size());
+    for (const auto &item : opts) {
+        auto res(index_.insert
+                 (std::make_pair(item.first, ConfigValue())));
+        if (!res.second) { continue; }
+
+        auto &value(res.first->second);
+        value.values = item.second;
+        value.file = fileIndex;
+        auto flines(lines.find(item.first));
+        value.line = (flines == lines.end()) ? 0 : flines->second;
+
+        keys_.insert(keys_.end(), item.first);
+    }
+
+    config.push_back(std::move(opts));
+    files_.push_back(file);
+}
+
+UnrecognizedOptions::Keys
+UnrecognizedOptions::configKeys(const std::string &prefix) const
+{
+    Keys k;
+    for (auto ikeys(keys_.lower_bound(prefix)), ekeys(keys_.end());
+         (ikeys != ekeys) && !ikeys->compare(0, prefix.size(), prefix);
+         ++ikeys)
+    {
+        k.insert(k.end(), *ikeys);
+    }
     return k;
 }
 
+const UnrecognizedOptions::ConfigValue*
+UnrecognizedOptions::findConfigOption(const std::string &key) const
+{
+    auto findex(index_.find(key));
+    return (findex == index_.end()) ? nullptr : &findex->second;
+}
+
 const std::string&
 UnrecognizedOptions::singleConfigOption(const std::string &key) const
 {
-    for (const auto &co : config) {
-        for (const auto &item : co) {
-            if (item.first != key) { continue; }
-            if (item.second.empty()) { continue; }
-            if (item.second.size() != 1) {
-                po::multiple_values e;
-                e.set_option_name(key);
-                throw e;
-            }
-            return item.second.front();
-        }
-    }
+    const auto *value(findConfigOption(key));
+    if (!value) { throw po::required_option(key); }
 
-    throw po::required_option(key);
+    if (value->values.size() != 1) {
+        po::multiple_values e;
+        e.set_option_name(key);
+        throw e;
+    }
+    return value->values.front();
 }
 
 UnrecognizedOptions::OptionList
 UnrecognizedOptions::multiConfigOption(const std::string &key) const
 {
-    for (const auto &co : config) {
-        for (const auto &item : co) {
-            if (item.first != key) { continue; }
-            if (item.second.empty()) { continue; }
-            return item.second;
-        }
-    }
-
-    throw po::required_option(key);
+    const auto *value(findConfigOption(key));
+    if (!value) { throw po::required_option(key); }
+    return value->values;
 }
 
 bool HelpPrinter::help(std::ostream &, const std::string &) const {
@@ -33,11 +33,13 @@
 #include <ctime>
 #include <functional>
 #include <set>
+#include <unordered_map>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
 
 #include <dbglog/dbglog.hpp>
 
@@ -63,6 +65,12 @@ constexpr int DISABLE_EXCESSIVE_LOGGING = 0x04;
 constexpr int SHOW_LICENCE_INFO = 0x08;
 constexpr int ENABLE_CONFIG_UNRECOGNIZED_OPTIONS = 0x10;
 constexpr int SHOW_EXPANDED_COMMAND_LINE = 0x20;
+/** Shell-like response files: quoting, escapes, # comments and nested
+ *  @file includes (see detail::ResponseFileReader). Not compatible with
+ *  plain files: a backslash, apostrophe, leading '@' or '#' changes
+ *  meaning.
+ */
+constexpr int ENABLE_SHELL_RESPONSE_FILES = 0x40;
 
 struct UnrecognizedOptions;
 
@@ -268,17 +276,50 @@ struct UnrecognizedOptions {
     // config stuff
     typedef std::map<std::string, OptionList> ConfigOptions;
     typedef std::vector<ConfigOptions> MultipleConfigOptions;
+    typedef std::vector<boost::filesystem::path> Files;
+
+    /** Config options per config file, filled in by add(). Kept for
+     *  existing users; lookup functions below use an index built by add()
+     *  and do not see changes made directly to this member.
+     */
     MultipleConfigOptions config;
 
+    /** Config files the config options come from (same indices).
+     */
+    const Files& files() const { return files_; }
+
     /** All keys seen in config all files (in order they have been read).
      */
     std::vector<std::string> seenConfigKeys;
 
     typedef std::set<std::string> Keys;
 
+    /** Values of first occurrence of a key and where it comes from.
+     */
+    struct ConfigValue {
+        OptionList values;
+
+        /** Index to files()/config.
+         */
+        std::size_t file;
+
+        /** Line of first occurrence in the file (1-based), 0 if unknown.
+         */
+        unsigned int line;
+    };
+
     /** Collects all keys used in the config.
      */
-    Keys configKeys() const;
+    const Keys& configKeys() const { return keys_; }
+
+    /** Keys with given prefix, e.g. "layer." for all keys in [layer]
+     *  section.
+     */
+    Keys configKeys(const std::string &prefix) const;
+
+    /** Returns first occurence of key in config, nullptr if not found.
+     */
+    const ConfigValue* findConfigOption(const std::string &key) const;
 
     /** Returns first occurence of key in config.
      *  Throws boost::program_options::required_value if not found.
@@ -293,7 +334,19 @@ struct UnrecognizedOptions {
      */
     OptionList multiConfigOption(const std::string &key) const;
 
+    /** Adds unregistered options parsed from given config file and updates
+     *  the index. File content (if non-empty) is used to find line numbers.
+     */
+    void add(const po::parsed_options &parsed
+             , const boost::filesystem::path &file
+             , boost::string_view content = boost::string_view());
+
     UnrecognizedOptions() {}
+
+private:
+    Files files_;
+    std::unordered_map<std::string, ConfigValue> index_;
+    Keys keys_;
 };
 
 // inlines
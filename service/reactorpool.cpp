@@ -0,0 +1,268 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <limits>
+
+#include <boost/optional.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "reactorpool.hpp"
+#include "threadregistry.hpp"
+
+namespace asio = boost::asio;
+
+namespace service {
+
+namespace {
+
+thread_local const ReactorPool::Detail *currentPool(nullptr);
+
+} // namespace
+
+struct ReactorPool::Detail {
+    struct Context {
+        Reactor ios;
+        boost::optional<Reactor::work> work;
+        asio::steady_timer probe;
+        std::thread thread;
+
+        std::atomic<int> load;
+
+        // lag probe results (timer expiry to handler run), in microseconds
+        std::atomic<std::uint64_t> lagLast;
+        std::atomic<std::uint64_t> lagAvg;
+        std::atomic<std::uint64_t> lagMax;
+
+        Context()
+            : probe(ios), load(0), lagLast(0), lagAvg(0), lagMax(0)
+        {
+            work.emplace(ios);
+        }
+    };
+
+    Detail(const std::string &name, const Params &params);
+
+    void run(unsigned int index);
+    void startProbe(Context &ctx);
+    void probed(Context &ctx, const boost::system::error_code &ec);
+
+    void cancel();
+    void stop();
+
+    const std::string name;
+    const Params params;
+    std::vector<std::unique_ptr<Context> > contexts;
+    std::atomic<unsigned int> next;
+};
+
+ReactorPool::Detail::Detail(const std::string &name, const Params &params)
+    : name(name), params(params), next(0)
+{
+    const auto size(std::max(1u, params.size));
+    for (unsigned int i(0); i < size; ++i) {
+        contexts.emplace_back(new Context());
+        startProbe(*contexts.back());
+    }
+
+    for (unsigned int i(0); i < size; ++i) {
+        contexts[i]->thread = std::thread(&Detail::run, this, i);
+    }
+
+    LOG(info2) << "Reactor pool <" << name << "> started with "
+               << size << " reactors.";
+}
+
+void ReactorPool::Detail::run(unsigned int index)
+{
+    auto registration(registerThread(name + std::to_string(index), name));
+    currentPool = this;
+
+    if (!params.cpus.empty()) {
+        const auto cpu(params.cpus[index % params.cpus.size()]);
+        try {
+            setAffinity(CpuList({ cpu }));
+        } catch (const std::exception &e) {
+            LOG(warn3) << "Cannot pin reactor <" << index << "> to CPU "
+                       << cpu << ": <" << e.what() << ">.";
+        }
+    }
+
+    auto &ios(contexts[index]->ios);
+    for (;;) {
+        try {
+            ios.run();
+            break;
+        } catch (const std::exception &e) {
+            LOG(err3)
+                << "Uncaught exception in reactor <" << name << index
+                << ">: <" << e.what() << ">. Going on.";
+        }
+    }
+
+    currentPool = nullptr;
+}
+
+void ReactorPool::Detail::startProbe(Context &ctx)
+{
+    ctx.probe.expires_from_now(params.probeInterval);
+    ctx.probe.async_wait([this, &ctx](const boost::system::error_code &ec)
+    {
+        probed(ctx, ec);
+    });
+}
+
+void ReactorPool::Detail::probed(Context &ctx
+                                 , const boost::system::error_code &ec)
+{
+    if (ec) { return; }
+
+    const std::uint64_t lag
+        (std::chrono::duration_cast<std::chrono::microseconds>
+         (asio::steady_timer::clock_type::now()
+          - ctx.probe.expires_at()).count());
+
+    ctx.lagLast = lag;
+    // exponential moving average, 1/8 weight of new sample
+    ctx.lagAvg = (7 * ctx.lagAvg + lag) / 8;
+    if (lag > ctx.lagMax) { ctx.lagMax = lag; }
+
+    startProbe(ctx);
+}
+
+void ReactorPool::Detail::cancel()
+{
+    for (auto &ctx : contexts) {
+        ctx->ios.stop();
+    }
+}
+
+void ReactorPool::Detail::stop()
+{
+    if (currentPool == this) {
+        LOGTHROW(err2, std::logic_error)
+            << "Reactor pool <" << name << "> cannot be stopped from "
+            "its own thread.";
+    }
+
+    cancel();
+    for (auto &ctx : contexts) {
+        if (ctx->thread.joinable()) { ctx->thread.join(); }
+    }
+}
+
+ReactorPool::ReactorPool(const std::string &name, const Params &params)
+    : detail_(new Detail(name, params))
+{}
+
+ReactorPool::~ReactorPool()
+{
+    if (detail_) { detail().stop(); }
+}
+
+ReactorPool::Lease ReactorPool::lease(Selection selection)
+{
+    auto &contexts(detail().contexts);
+    const auto start(detail().next++ % contexts.size());
+
+    auto index(start);
+    if (selection == Selection::leastLoaded) {
+        // scan from round-robin start to break ties fairly
+        auto min(std::numeric_limits<int>::max());
+        for (std::size_t i(0); i < contexts.size(); ++i) {
+            const auto candidate((start + i) % contexts.size());
+            const int load(contexts[candidate]->load);
+            if (load < min) {
+                min = load;
+                index = candidate;
+            }
+        }
+    }
+
+    ++contexts[index]->load;
+    return Lease(this, index);
+}
+
+ReactorPool::Reactor& ReactorPool::operator[](unsigned int index)
+{
+    return detail().contexts.at(index)->ios;
+}
+
+unsigned int ReactorPool::size() const
+{
+    return detail().contexts.size();
+}
+
+void ReactorPool::cancel()
+{
+    detail().cancel();
+}
+
+void ReactorPool::stop()
+{
+    detail().stop();
+}
+
+void ReactorPool::monitor(std::ostream &os, const std::string &prefix)
+{
+    auto &contexts(detail().contexts);
+    os << prefix << "Count: " << contexts.size() << "\n";
+    for (std::size_t i(0); i < contexts.size(); ++i) {
+        auto &ctx(*contexts[i]);
+        os << prefix << i << ": load " << ctx.load
+           << ", timer lag " << ctx.lagLast << " us (avg " << ctx.lagAvg
+           << " us, max " << ctx.lagMax.exchange(0) << " us)\n";
+    }
+}
+
+ReactorPool::Lease& ReactorPool::Lease::operator=(Lease &&other)
+{
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        index_ = other.index_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+ReactorPool::Reactor& ReactorPool::Lease::reactor() const
+{
+    return (*pool_)[index_];
+}
+
+void ReactorPool::Lease::release()
+{
+    if (!pool_) { return; }
+    --pool_->detail().contexts[index_]->load;
+    pool_ = nullptr;
+}
+
+} // namespace service
@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_reactorpool_hpp_included_
+#define service_reactorpool_hpp_included_
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <ostream>
+
+#include <boost/asio/io_service.hpp>
+
+#include "affinity.hpp"
+
+namespace service {
+
+/** Pool of asio io_services, each run by its own thread (one reactor per
+ *  core). New connections are spread over reactors by lease(): every
+ *  reactor counts its active leases (load) which drives least-loaded
+ *  selection.
+ *
+ *  Each reactor periodically runs a lag probe: a timer whose handler
+ *  measures how late it was run past its expiry, i.e. how long a ready
+ *  handler waits for the loop. It says nothing about how long handlers
+ *  themselves run.
+ *
+ *  Threads are registered (see registerThread()) as "<name><index>" with
+ *  role <name>.
+ */
+class ReactorPool {
+public:
+    typedef boost::asio::io_service Reactor;
+
+    struct Params {
+        /** Number of reactors (threads), zero means one.
+         */
+        unsigned int size;
+
+        /** Pin reactor i to cpus[i % cpus.size()] unless empty.
+         */
+        CpuList cpus;
+
+        /** Lag probe period.
+         */
+        std::chrono::milliseconds probeInterval;
+
+        Params() : size(1), probeInterval(1000) {}
+    };
+
+    enum class Selection { roundRobin, leastLoaded };
+
+    /** Assignment of a reactor to a client (e.g. connection). Counts into
+     *  reactor's load until destroyed.
+     */
+    class Lease {
+    public:
+        Lease() : pool_(), index_() {}
+        Lease(Lease &&other) : pool_(other.pool_), index_(other.index_) {
+            other.pool_ = nullptr;
+        }
+        Lease& operator=(Lease &&other);
+        ~Lease() { release(); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        Reactor& reactor() const;
+        unsigned int index() const { return index_; }
+
+        explicit operator bool() const { return pool_; }
+
+        void release();
+
+    private:
+        friend class ReactorPool;
+        Lease(ReactorPool *pool, unsigned int index)
+            : pool_(pool), index_(index) {}
+
+        ReactorPool *pool_;
+        unsigned int index_;
+    };
+
+    ReactorPool(const std::string &name, const Params &params = Params());
+
+    /** Stops the pool, see stop().
+     */
+    ~ReactorPool();
+
+    ReactorPool(const ReactorPool&) = delete;
+    ReactorPool& operator=(const ReactorPool&) = delete;
+
+    /** Selects reactor for a new client.
+     */
+    Lease lease(Selection selection = Selection::leastLoaded);
+
+    Reactor& operator[](unsigned int index);
+
+    unsigned int size() const;
+
+    /** Stops all reactors; pending handlers are abandoned. Does not wait;
+     *  safe to call from any thread, including reactor threads.
+     */
+    void cancel();
+
+    /** Stops all reactors and joins their threads. Must not be called from
+     *  a reactor thread.
+     */
+    void stop();
+
+    /** Prints per-reactor load and timer lag measured by the lag probe
+     *  (last, average and maximum since previous call), one "Key: value"
+     *  per line prefixed with given prefix.
+     */
+    void monitor(std::ostream &os, const std::string &prefix = "Reactor-");
+
+    struct Detail;
+
+private:
+    std::unique_ptr<Detail> detail_;
+    Detail& detail() { return *detail_; }
+    const Detail& detail() const { return *detail_; }
+};
+
+} // namespace service
+
+#endif // service_reactorpool_hpp_included_
@@ -30,9 +30,14 @@
 #include <tuple>
 #include <cstring>
 #include <iomanip>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <algorithm>
 
 #include <signal.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <pwd.h>
 #include <grp.h>
@@ -43,12 +48,18 @@
 
 #include "service.hpp"
 #include "pidfile.hpp"
+#include "threadregistry.hpp"
 #include "detail/signalhandler.hpp"
+#include "detail/procfs.hpp"
+#include "detail/resources.hpp"
+#include "detail/malloc.hpp"
+#include "detail/profiler.hpp"
 
 #include "utility/steady-clock.hpp"
 #include "utility/time.hpp"
 #include "utility/path.hpp"
 #include "utility/environment.hpp"
+#include "utility/raise.hpp"
 
 namespace fs = boost::filesystem;
 
@@ -58,6 +69,11 @@ Service::Service(const std::string &name, const std::string &version
                  , int flags)
     : Program(name, version, flags)
     , daemonize_(false)
+    , mallocConfig_(std::make_shared<detail::MallocConfig>())
+    , usage_(std::make_shared<detail::UsageMonitor>())
+    , mainPid_(0), pinWorkers_(false)
+    , nextWorkerIndex_(0), threads_(0), reactorCount_(0)
+    , pinReactors_(false), fastExit_(false), logTimePrecision_(0)
 {}
 
 Service::~Service()
@@ -200,6 +216,24 @@ void loginEnv(const Service::Config &config, const Persona &persona)
     utility::apply(env);
 }
 
+void applyPlacement(dbglog::module &log, const Service::Config &config)
+{
+    if (!config.cpuAffinity.empty()) {
+        const auto cpus(CpuList::parse(config.cpuAffinity));
+        LOG(info3, log) << "Setting CPU affinity to <" << cpus << ">.";
+        setAffinity(cpus);
+    }
+
+    if (!config.numaPolicy.empty()) {
+        const auto policy(parseNumaPolicy(config.numaPolicy));
+        const auto nodes(CpuList::parse(config.numaNode));
+        LOG(info3, log)
+            << "Setting NUMA policy to <" << asString(policy)
+            << "> (nodes <" << nodes << ">).";
+        setNumaPolicy(policy, nodes);
+    }
+}
+
 struct SigDef {
     std::string signal;
     int signo;
@@ -417,7 +451,7 @@ extern "C" {
 
 boost::optional<detail::CtrlConfig> optional(const detail::CtrlConfig &cc)
 {
-    if (cc.path.empty()) { return boost::none; }
+    if (cc.path.empty() && cc.listen.empty()) { return boost::none; }
     return cc;
 }
 
@@ -454,7 +488,8 @@ void Service::preConfigHook(const po::variables_map &vars)
 
 int Service::operator()(int argc, char *argv[])
 {
-    dbglog::thread_id("main");
+    // keep application's dbglog thread id
+    auto mainThread(listThread("main", "main"));
 
     bool daemonize(false);
 
@@ -462,6 +497,7 @@ int Service::operator()(int argc, char *argv[])
     fs::path pidFilePath;
 
     detail::CtrlConfig ctrlConfig;
+    detail::ResourceConfig resourceConfig;
 
     try {
         po::options_description genericCmdline("command line options");
@@ -488,10 +524,18 @@ int Service::operator()(int argc, char *argv[])
 
         ctrlConfig.configuration(genericCmdline, genericConfig);
         config.configuration(genericCmdline, genericConfig);
+        resourceConfig.configuration(genericCmdline, genericConfig);
+        mallocConfig_->configuration(genericCmdline, genericConfig);
 
         auto vm(Program::configure(argc, argv, genericCmdline, genericConfig));
         ctrlConfig.configure(vm);
         config.configure(vm);
+        resourceConfig.configure(vm);
+        mallocConfig_->configure(vm);
+        builtinTunables(vm);
+
+        // allocator tuning must happen before any significant allocation
+        mallocConfig_->apply(log_);
 
         daemonize_ = daemonize = vm.count("daemonize");
         daemonizeNochdir = vm.count("daemonize-nochdir");
@@ -529,8 +573,15 @@ int Service::operator()(int argc, char *argv[])
         if (!ctrlConfig.path.empty()) {
             ctrlConfig.path = absolute(ctrlConfig.path);
         }
+
+        if (!config.snapshot.empty()) {
+            config.snapshot = absolute(config.snapshot);
+        }
     } catch (const immediate_exit &e) {
         return e.code;
+    } catch (const po::error &e) {
+        std::cerr << name << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
     }
 
     LOG(info4, log_) << "Service " << identity() << " starting.";
@@ -660,8 +711,14 @@ int Service::operator()(int argc, char *argv[])
 
     // start signal handler in main process (before persona switch because of
     // socket)
+    mainPid_ = ::getpid();
     signalHandler_ = std::make_shared<detail::SignalHandler>
-        (log_, *this, ::getpid(), optional(ctrlConfig));
+        (log_, *this, mainPid_, optional(ctrlConfig));
+
+    // limits and memory locking may need privileges
+    if (!resourceConfig.apply(log_)) {
+        return EXIT_FAILURE;
+    }
 
     {
         auto privilegesRegainable(prePersonaSwitch());
@@ -674,6 +731,21 @@ int Service::operator()(int argc, char *argv[])
         postPersonaSwitch();
     }
 
+    // CPU/memory placement, inherited by all threads and workers
+    try {
+        applyPlacement(log_, config);
+        cpus_ = CpuList::allowed();
+        pinWorkers_ = config.pinWorkers;
+        threads_ = config.threads;
+        fastExit_ = config.fastExit;
+        snapshotPath_ = config.snapshot;
+        reactorCount_ = config.reactors;
+        pinReactors_ = config.pinReactors;
+    } catch (const std::exception &e) {
+        LOG(fatal, log_) << "Cannot apply placement: " << e.what();
+        return EXIT_FAILURE;
+    }
+
     // we are the one that terminates whole daemon!
     globalTerminate(true);
 
@@ -683,6 +755,18 @@ int Service::operator()(int argc, char *argv[])
         detail::SignalHandler::ScopedHandler signals(*signalHandler_);
 
         Cleanup cleanup;
+
+        // ordered teardown (components, pools, workers, snapshot, cleanup)
+        // when leaving this scope; snapshot only after successful run
+        struct Teardown {
+            Service &service;
+            Cleanup &cleanup;
+            bool snapshot;
+            ~Teardown() { service.shutdown(cleanup, false, snapshot); }
+        } teardown{*this, cleanup, false};
+
+        openSnapshot(config.snapshotMaxAge);
+
         try {
             cleanup = start();
         } catch (const immediate_exit &e) {
@@ -693,6 +777,23 @@ int Service::operator()(int argc, char *argv[])
             return e.code;
         }
 
+        if (!components_.empty()) {
+            try {
+                // not on workers(): a component start may wait for tasks
+                // posted there
+                Executor startup("startup", threads_ ? threads_
+                                 : cpus_.size());
+                components_.start(startup, cancellation_, *this);
+            } catch (const std::exception &e) {
+                LOG(fatal, log_)
+                    << "Component startup failed: <" << e.what() << ">.";
+                return EXIT_FAILURE;
+            }
+        }
+
+        // restore is over, keep mapping only if referenced by readers
+        snapshots_.restore({});
+
         if (!isRunning()) {
             LOG(info4, log_) << "Terminated during startup.";
             return EXIT_FAILURE;
@@ -703,6 +804,12 @@ int Service::operator()(int argc, char *argv[])
         }
 
         code = run();
+        teardown.snapshot = !code;
+
+        if (fastExit_) {
+            // does not return
+            fastExit(cleanup, code, pidFilePath);
+        }
     }
 
     if (code) {
@@ -717,15 +824,341 @@ int Service::operator()(int argc, char *argv[])
 void Service::stop()
 {
     signalHandler_->terminate();
+    cancellation_.cancel();
 }
 
 bool Service::isRunning() {
-    return !signalHandler_->process();
+    if (signalHandler_->process()) {
+        cancellation_.cancel();
+        return false;
+    }
+    return true;
+}
+
+Executor& Service::workers()
+{
+    std::lock_guard<std::mutex> guard(poolsMutex_);
+    if (executor_) { return *executor_; }
+
+    if (cpus_.empty()) {
+        LOGTHROW(err3, std::logic_error)
+            << "Workers pool is available only in a running service.";
+    }
+
+    executor_.reset(new Executor
+                    ("workers", threads_ ? threads_ : cpus_.size()));
+    return *executor_;
+}
+
+ReactorPool& Service::reactors()
+{
+    std::lock_guard<std::mutex> guard(poolsMutex_);
+    if (reactors_) { return *reactors_; }
+
+    if (cpus_.empty()) {
+        LOGTHROW(err3, std::logic_error)
+            << "Reactor pool is available only in a running service.";
+    }
+
+    ReactorPool::Params params;
+    params.size = reactorCount_ ? reactorCount_ : cpus_.size();
+    if (pinReactors_) { params.cpus = cpus_; }
+
+    reactors_.reset(new ReactorPool("reactor", params));
+    return *reactors_;
+}
+
+void Service::shutdown(Cleanup &cleanup, bool fast, bool snapshot)
+{
+    typedef std::chrono::steady_clock Clock;
+    const auto since(Clock::now());
+    auto phaseStart(since);
+
+    const auto phase([&](const char *name)
+    {
+        const auto now(Clock::now());
+        LOG(info3, log_)
+            << "Shutdown: " << name << " took "
+            << std::chrono::duration_cast<std::chrono::milliseconds>
+            (now - phaseStart).count() << " ms.";
+        phaseStart = now;
+    });
+
+    components_.stop();
+    phase("components");
+
+    // threads die with the process on fast exit
+    stopPools(!fast);
+    phase("pools");
+
+    reapWorkers();
+    phase("workers");
+
+    // state is quiescent now but still alive
+    if (snapshot) {
+        saveSnapshot();
+        phase("snapshot");
+    }
+
+    if (!fast) {
+        cleanup.reset();
+        phase("cleanup");
+    }
+
+    LOG(info3, log_)
+        << "Shutdown took "
+        << std::chrono::duration_cast<std::chrono::milliseconds>
+        (Clock::now() - since).count() << " ms.";
+}
+
+void Service::fastExit(Cleanup &cleanup, int code
+                       , const boost::filesystem::path &pidFile)
+{
+    LOG(info4, log_) << "Fast exit, skipping cleanup.";
+    shutdown(cleanup, true, !code);
+
+    signalHandler_->removeCtrlSocket();
+    if (!pidFile.empty()) {
+        boost::system::error_code ec;
+        fs::remove(pidFile, ec);
+    }
+
+    if (code) {
+        LOG(err4, log_) << "Terminated with error " << code << '.';
+    } else {
+        LOG(info4, log_) << "Normal shutdown.";
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    ::_exit(code);
+}
+
+void Service::openSnapshot(long maxAge)
+{
+    if (snapshotPath_.empty()) { return; }
+
+    auto snapshot(Snapshot::open(snapshotPath_, name + " " + version
+                                 , maxAge));
+    if (!snapshot) { return; }
+
+    // consume: a snapshot must not outlive state of this instance
+    boost::system::error_code ec;
+    fs::remove(snapshotPath_, ec);
+    if (ec) {
+        LOG(warn3, log_) << "Cannot remove consumed snapshot "
+                         << snapshotPath_ << ": <" << ec.message() << ">.";
+    }
+
+    snapshots_.restore(snapshot);
+}
+
+void Service::saveSnapshot()
+{
+    if (snapshotPath_.empty() || snapshots_.empty()) { return; }
+
+    try {
+        snapshots_.save(snapshotPath_, name + " " + version);
+    } catch (const std::exception &e) {
+        LOG(err3, log_) << "Cannot save snapshot: <" << e.what() << ">.";
+    }
+}
+
+void Service::stopPools(bool join)
+{
+    Executor *executor;
+    ReactorPool *reactors;
+    {
+        std::lock_guard<std::mutex> guard(poolsMutex_);
+        executor = executor_.get();
+        reactors = reactors_.get();
+    }
+
+    // NB: not under lock, running tasks may call isRunning()/stop()
+    if (join) {
+        if (reactors) { reactors->stop(); }
+        if (executor) { executor->stop(); }
+    } else {
+        if (reactors) { reactors->cancel(); }
+        if (executor) { executor->cancel(); }
+    }
+}
+
+std::vector< ::pid_t> Service::forkWorkers(unsigned int count
+                                           , const WorkerEntry &entry)
+{
+    if (!signalHandler_ || (::getpid() != mainPid_)) {
+        LOGTHROW(err3, std::logic_error)
+            << "Workers can be forked only by a running service's "
+            "main process.";
+    }
+
+    // threads holding locks (dbglog, registry, pools) at fork would leave
+    // them locked forever in the child
+    {
+        std::lock_guard<std::mutex> guard(poolsMutex_);
+        if (executor_ || reactors_) {
+            LOGTHROW(err3, std::logic_error)
+                << "Workers cannot be forked once workers() or reactors() "
+                "pool exists.";
+        }
+    }
+    if (detail::Profiler::instance().status().running) {
+        LOGTHROW(err3, std::logic_error)
+            << "Workers cannot be forked while profiler is running.";
+    }
+
+    std::vector< ::pid_t> pids;
+
+    for (unsigned int i(0); i < count; ++i) {
+        const auto index(nextWorkerIndex_++);
+
+        const auto pid(::fork());
+        if (-1 == pid) {
+            std::system_error e(errno, std::system_category());
+            LOG(err3, log_)
+                << "Cannot fork worker <" << index << ">: <"
+                << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+
+        if (!pid) {
+            // worker process; NB: must be terminated only by _exit
+            {
+                std::lock_guard<std::mutex> guard(workersMutex_);
+                workers_.clear();
+            }
+            auto workerThread(registerThread("worker" + std::to_string(index)
+                                             , "worker"));
+
+            if (!signalHandler_->globalTerminate(true, 0)) {
+                LOG(warn3, log_)
+                    << "No free global terminate slot for worker <"
+                    << index << ">.";
+            }
+
+            if (pinWorkers_) {
+                try {
+                    pinThread(index);
+                } catch (const std::exception &e) {
+                    LOG(warn3, log_)
+                        << "Cannot pin worker <" << index << ">: <"
+                        << e.what() << ">.";
+                }
+            }
+
+            LOG(info3, log_) << "Worker <" << index << "> started.";
+
+            int code(EXIT_FAILURE);
+            try {
+                code = entry(index);
+            } catch (const immediate_exit &e) {
+                code = e.code;
+            } catch (const std::exception &e) {
+                LOG(fatal, log_)
+                    << "Worker <" << index << "> failed: <"
+                    << e.what() << ">.";
+            } catch (...) {
+                LOG(fatal, log_)
+                    << "Worker <" << index << "> failed with unknown "
+                    "exception.";
+            }
+
+            LOG(info3, log_)
+                << "Worker <" << index << "> finished with code "
+                << code << ".";
+            ::_exit(code);
+        }
+
+        LOG(info3, log_)
+            << "Forked worker <" << index << "> with pid <" << pid << ">.";
+
+        {
+            std::lock_guard<std::mutex> guard(workersMutex_);
+            workers_.push_back({ index, pid });
+        }
+        pids.push_back(pid);
+    }
+
+    return pids;
 }
 
-void Service::globalTerminate(bool value, long pid)
+int Service::pinThread(unsigned int index)
 {
-    signalHandler_->globalTerminate(value, pid);
+    if (cpus_.empty()) {
+        LOGTHROW(err3, std::logic_error)
+            << "Threads can be pinned only in a running service.";
+    }
+
+    const auto cpu(cpus_[index % cpus_.size()]);
+    setAffinity(CpuList({ cpu }));
+    LOG(info2, log_) << "Pinned thread to CPU " << cpu << ".";
+    return cpu;
+}
+
+void Service::reapWorkers()
+{
+    std::vector<Worker> workers;
+    {
+        std::lock_guard<std::mutex> guard(workersMutex_);
+        workers.swap(workers_);
+    }
+
+    if (workers.empty()) { return; }
+
+    // tell workers to terminate
+    signalHandler_->terminate();
+
+    LOG(info3, log_)
+        << "Waiting for " << workers.size() << " worker(s) to terminate.";
+
+    const auto deadline(utility::steady_clock::now()
+                        + std::chrono::seconds(30));
+
+    for (const auto &worker : workers) {
+        int status(0);
+        for (;;) {
+            const auto r(::waitpid(worker.pid, &status, WNOHANG));
+            if (r == worker.pid) { break; }
+
+            if (-1 == r) {
+                if (EINTR == errno) { continue; }
+                std::system_error e(errno, std::system_category());
+                LOG(warn3, log_)
+                    << "Cannot wait for worker <" << worker.index << ">: <"
+                    << e.code() << ", " << e.what() << ">.";
+                status = -1;
+                break;
+            }
+
+            if (utility::steady_clock::now() >= deadline) {
+                LOG(warn3, log_)
+                    << "Worker <" << worker.index << "> (pid <"
+                    << worker.pid << ">) did not terminate in time, "
+                    "killing.";
+                ::kill(worker.pid, SIGKILL);
+                while ((-1 == ::waitpid(worker.pid, &status, 0))
+                       && (EINTR == errno));
+                break;
+            }
+
+            ::usleep(10000);
+        }
+
+        signalHandler_->globalTerminate(false, worker.pid);
+
+        if (status < 0) { continue; }
+        if (WIFEXITED(status)) {
+            LOG(info3, log_)
+                << "Worker <" << worker.index << "> exited with code "
+                << WEXITSTATUS(status) << ".";
+        } else if (WIFSIGNALED(status)) {
+            LOG(warn3, log_)
+                << "Worker <" << worker.index << "> killed by signal "
+                << WTERMSIG(status) << ".";
+        }
+    }
 }
 
 void Service::configure(const std::vector<std::string>&)
@@ -740,6 +1173,116 @@ bool Service::help(std::ostream &, const std::string &) const
     return false;
 }
 
+namespace {
+
+void printThreads(std::ostream &os)
+{
+    std::map< ::pid_t, RegisteredThread> registered;
+    for (const auto &thread : registeredThreads()) {
+        registered[thread.tid] = thread;
+    }
+
+    auto tasks(detail::taskStats());
+    std::sort(tasks.begin(), tasks.end()
+              , [](const detail::TaskStat &l, const detail::TaskStat &r)
+              {
+                  return l.tid < r.tid;
+              });
+
+    os << std::left << std::setw(8) << "tid" << std::setw(17) << "name"
+       << std::setw(11) << "role" << std::right << std::setw(6) << "state"
+       << std::setw(5) << "cpu" << std::setw(12) << "user[ms]"
+       << std::setw(12) << "system[ms]" << std::setw(10) << "vcsw"
+       << std::setw(10) << "ivcsw" << '\n';
+
+    for (const auto &task : tasks) {
+        const auto fregistered(registered.find(task.tid));
+        const bool known(fregistered != registered.end());
+
+        os << std::left << std::setw(8) << task.tid
+           << std::setw(17)
+           << (known ? fregistered->second.name : task.comm)
+           << std::setw(11)
+           << ((known && !fregistered->second.role.empty())
+               ? fregistered->second.role : "-")
+           << std::right << std::setw(6) << task.state
+           << std::setw(5) << task.lastCpu
+           << std::setw(12) << task.userTime.count()
+           << std::setw(12) << task.systemTime.count()
+           << std::setw(10) << task.voluntarySwitches
+           << std::setw(10) << task.involuntarySwitches << '\n';
+    }
+}
+
+} // namespace
+
+void Service::profileCtrl(const CtrlCommand &cmd, std::ostream &output)
+{
+    auto &profiler(detail::Profiler::instance());
+
+    const auto printStatus([&](const detail::Profiler::Status &status)
+    {
+        output << "running: " << (status.running ? "yes" : "no")
+               << "\nsamples: " << status.samples
+               << "\ndropped: " << status.dropped
+               << "\noutput: " << status.output.string() << "\n";
+    });
+
+    if (cmd.args.empty()) {
+        printStatus(profiler.status());
+        return;
+    }
+
+    const auto &what(cmd.args.front());
+    if (what == "stop") {
+        try {
+            printStatus(profiler.stop());
+        } catch (const std::runtime_error &e) {
+            utility::raise<utility::CtrlCommandError>("%s", e.what());
+        }
+        return;
+    }
+
+    if (what != "start") {
+        utility::raise<utility::CtrlCommandError>
+            ("unknown profile subcommand <%s>", what);
+    }
+
+    unsigned int hz(99);
+    long seconds(30);
+    try {
+        if (cmd.args.size() > 1) {
+            hz = boost::lexical_cast<unsigned int>(cmd.args[1]);
+        }
+        if (cmd.args.size() > 2) {
+            seconds = boost::lexical_cast<long>(cmd.args[2]);
+        }
+    } catch (const boost::bad_lexical_cast&) {
+        utility::raise<utility::CtrlCommandError>
+            ("invalid profile parameters");
+    }
+
+    // next to log file (or in temp directory if there is none)
+    auto dir(logFile().parent_path());
+    if (logFile().empty()) { dir = fs::temp_directory_path(); }
+
+    char timestamp[32];
+    const auto now(std::time(nullptr));
+    std::tm tm;
+    ::localtime_r(&now, &tm);
+    std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", &tm);
+
+    const auto path(dir / (name + "." + std::to_string(::getpid())
+                           + "." + timestamp + ".folded"));
+
+    try {
+        profiler.start(hz, std::chrono::seconds(seconds), path);
+    } catch (const std::runtime_error &e) {
+        utility::raise<utility::CtrlCommandError>("%s", e.what());
+    }
+    printStatus(profiler.status());
+}
+
 void Service::processCtrl(const CtrlCommand &cmd, std::ostream &output)
 {
     // service supported commands
@@ -748,19 +1291,117 @@ void Service::processCtrl(const CtrlCommand &cmd, std::ostream &output)
             << "stat           shows service statistics\n"
             << "monitor        returns information suitable for service "
             "monitoring\n"
+            << "threads        lists threads with CPU usage\n"
+            << "profile start [hz] [seconds]\n"
+            << "               starts CPU profiler (default 99 Hz, 30 s), "
+            "writes folded stacks next to the log file\n"
+            << "profile stop   stops running profiler\n"
+            << "profile        shows profiler status\n"
+            << "malloc [info|trim [pad]]\n"
+            << "               shows allocator settings and usage "
+            "(raw malloc_info), releases free memory\n"
+            << "list           lists runtime tunables with their values\n"
+            << "get <name>     shows value of given tunable\n"
+            << "set <name> <value>\n"
+            << "               changes value of given tunable\n"
             ;
 
         // let child class to append its own help
         ctrl(cmd, output);
     } else if (cmd.cmd == "stat") {
         stat(output);
+        executorStat(output);
     } else if (cmd.cmd == "monitor") {
         processMonitor(output);
-    } else if (!ctrl(cmd, output)) {
+    } else if (cmd.cmd == "threads") {
+        printThreads(output);
+    } else if (cmd.cmd == "profile") {
+        profileCtrl(cmd, output);
+    } else if (cmd.cmd == "malloc") {
+        detail::mallocCtrl(*mallocConfig_, cmd.args, output);
+    } else if (!ctrl(cmd, output) && !tunablesCtrl(cmd, output)) {
         output << "error: command <" << cmd.cmd << "> not implemented\n";
     }
 }
 
+void Service::builtinTunables(const po::variables_map &vm)
+{
+    if (vm.count("log.timePrecision")) {
+        logTimePrecision_ = vm["log.timePrecision"].as<unsigned short>();
+    }
+
+    tunables_.add("log.mask"
+                  , []() {
+                      return Tunables::format
+                          (dbglog::mask(dbglog::get_mask()));
+                  }
+                  , [](const std::string &value) {
+                      dbglog::set_mask(Tunables::parse<dbglog::mask>(value));
+                  }
+                  , "dbglog logging mask");
+
+    tunables_.add("log.timePrecision"
+                  , [this]() {
+                      return Tunables::format(logTimePrecision_.load());
+                  }
+                  , [this](const std::string &value) {
+                      const auto precision
+                          (Tunables::parse<unsigned short>(value));
+                      if (precision > 6) {
+                          throw std::invalid_argument("allowed range is 0-6");
+                      }
+                      dbglog::log_time_precision(precision);
+                      logTimePrecision_ = precision;
+                  }
+                  , "logged time sub-second precision (0-6 decimals)");
+}
+
+bool Service::tunablesCtrl(const CtrlCommand &cmd, std::ostream &output)
+{
+    const auto invalid([](const std::exception &e) {
+        utility::raise<utility::CtrlCommandError>("%s", e.what());
+    });
+
+    if (cmd.cmd == "list") {
+        tunables_.list(output);
+    } else if (cmd.cmd == "get") {
+        if (cmd.args.size() != 1) {
+            utility::raise<utility::CtrlCommandError>("usage: get <name>");
+        }
+        try {
+            output << tunables_.get(cmd.args.front()) << '\n';
+        } catch (const std::out_of_range &e) {
+            invalid(e);
+        }
+    } else if (cmd.cmd == "set") {
+        if (cmd.args.size() < 2) {
+            utility::raise<utility::CtrlCommandError>
+                ("usage: set <name> <value>");
+        }
+
+        // value may contain spaces
+        auto value(cmd.args[1]);
+        for (std::size_t i(2); i < cmd.args.size(); ++i) {
+            value += " " + cmd.args[i];
+        }
+
+        try {
+            const auto &name(cmd.args.front());
+            const auto old(tunables_.set(name, value));
+            output << name << ": " << old << " -> " << tunables_.get(name)
+                   << '\n';
+        } catch (const std::out_of_range &e) {
+            invalid(e);
+        } catch (const std::invalid_argument &e) {
+            invalid(e);
+        }
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
 bool Service::ctrl(const CtrlCommand &cmd, std::ostream &output)
 {
     (void) cmd;
@@ -773,6 +1414,7 @@ void Service::processStat()
 {
     std::ostringstream os;
     stat(os);
+    executorStat(os);
     LOG(info4) << Program::identity() << " statistics:\n" << os.str();
 }
 
@@ -781,6 +1423,12 @@ void Service::stat(std::ostream &output)
     output << "Service provides no statistics.\n";
 }
 
+void Service::executorStat(std::ostream &output)
+{
+    std::lock_guard<std::mutex> guard(poolsMutex_);
+    if (executor_) { executor_->stat(output, "Workers-Pool-"); }
+}
+
 namespace {
 
 typedef std::vector< ::gid_t> GidList;
@@ -815,6 +1463,34 @@ GidList getSupplementaryGroups()
     return list;
 }
 
+void printMemory(std::ostream &os
+                 , const boost::optional<detail::MemoryRollup> &mr)
+{
+    if (!mr) { os << "?"; return; }
+    os << "rss " << mr->rss << " kB, shared " << mr->shared()
+       << " kB, private " << mr->priv() << " kB, pss " << mr->pss << " kB";
+}
+
+void printPlacement(std::ostream &os)
+{
+    os << "Cpu-Affinity: ";
+    try {
+        os << CpuList::allowed();
+    } catch (const std::exception&) {
+        os << "?";
+    }
+
+    os << "\nNuma-Policy: ";
+    try {
+        const auto placement(numaPlacement());
+        os << asString(placement.policy);
+        if (!placement.nodes.empty()) { os << ' ' << placement.nodes; }
+    } catch (const std::exception&) {
+        os << "?";
+    }
+    os << "\n";
+}
+
 void printSupplementaryGroups(std::ostream &os)
 {
     try {
@@ -848,7 +1524,33 @@ void Service::processMonitor(std::ostream &output)
         << " (" << utility::formatDateTime(Program::upSince(), true) << " GMT)"
         << "\nUptime: " << uptime.count() << ' '
         << utility::formatDuration(uptime)
-        << "\n";
+        << "\nMemory: ";
+    printMemory(output, detail::smapsRollup());
+    output << "\n";
+    usage_->print(output);
+    printPlacement(output);
+    detail::printResources(output);
+
+    {
+        std::lock_guard<std::mutex> guard(workersMutex_);
+        if (!workers_.empty()) {
+            output << "Workers: " << workers_.size() << "\n";
+            for (const auto &worker : workers_) {
+                output << "Worker-" << worker.index << ": pid "
+                       << worker.pid << ", ";
+                printMemory(output, detail::smapsRollup(worker.pid));
+                output << "\n";
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(poolsMutex_);
+        if (reactors_) { reactors_->monitor(output); }
+    }
+
+    components_.monitor(output);
+
     monitor(output);
 }
 
@@ -868,12 +1570,57 @@ void Service::Config::configuration(po::options_description &cmdline
          , "Switch process persona to given group name.")
         ("service.loginEnv", po::value(&loginEnv)->default_value(loginEnv)
          , "Generate login-like environment variables (HOME, USER, ...).")
+        ("service.cpuAffinity", po::value(&cpuAffinity)
+         , "Restrict service to given CPUs (cpulist, e.g. 0-7,16-23).")
+        ("service.numaPolicy", po::value(&numaPolicy)
+         , "NUMA memory policy: default, bind, preferred, interleave "
+         "or local.")
+        ("service.numaNode", po::value(&numaNode)
+         , "NUMA nodes (nodelist) used by service.numaPolicy.")
+        ("service.pinWorkers", po::value(&pinWorkers)
+         ->default_value(pinWorkers)
+         , "Pin forked workers to allowed CPUs round-robin.")
+        ("service.threads", po::value(&threads)->default_value(threads)
+         , "Number of threads of the service's worker pool; 0 means number "
+         "of CPUs the service is allowed to run on.")
+        ("service.reactors", po::value(&reactors)->default_value(reactors)
+         , "Number of asio reactors (threads) of the service's reactor "
+         "pool; 0 means number of CPUs the service is allowed to run on.")
+        ("service.pinReactors", po::value(&pinReactors)
+         ->default_value(pinReactors)
+         , "Pin reactor threads to allowed CPUs round-robin.")
+        ("service.fastExit", po::value(&fastExit)->default_value(fastExit)
+         , "Exit via _exit(2) once components are stopped, skipping "
+         "start()'s cleanup and freeing of memory.")
+        ("service.snapshot", po::value(&snapshot)
+         , "Warm-restart snapshot file: written on graceful stop, restored "
+         "(and removed) on start.")
+        ("service.snapshotMaxAge", po::value(&snapshotMaxAge)
+         ->default_value(snapshotMaxAge)
+         , "Ignore snapshots older than given number of seconds "
+         "(0 = no limit).")
         ;
 }
 
 void Service::Config::configure(const po::variables_map &vars)
 {
     (void) vars;
+
+    // validate placement early
+    try {
+        CpuList::parse(cpuAffinity);
+        CpuList::parse(numaNode);
+        if (!numaPolicy.empty()) { parseNumaPolicy(numaPolicy); }
+    } catch (const std::exception &e) {
+        throw po::error(e.what());
+    }
+
+    if (!numaPolicy.empty() && (numaPolicy != "default")
+        && (numaPolicy != "local") && numaNode.empty())
+    {
+        throw po::error("service.numaPolicy <" + numaPolicy
+                        + "> needs service.numaNode.");
+    }
 }
 
 void Service::logRotate()
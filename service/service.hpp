@@ -27,6 +27,11 @@
 #define shared_service_service_hpp_included_
 
 #include <memory>
+#include <vector>
+#include <mutex>
+#include <functional>
+
+#include <sys/types.h>
 
 #include <boost/optional.hpp>
 
@@ -36,11 +41,20 @@
 
 #include "program.hpp"
 #include "persona.hpp"
+#include "affinity.hpp"
+#include "executor.hpp"
+#include "reactorpool.hpp"
+#include "cancellation.hpp"
+#include "components.hpp"
+#include "snapshot.hpp"
+#include "tunables.hpp"
 
 namespace service {
 
 namespace detail {
     class SignalHandler;
+    struct MallocConfig;
+    class UsageMonitor;
 } // namespace detail
 
 class Service : protected Program, public utility::Runnable {
@@ -56,17 +70,125 @@ public:
 
     void stop() override;
 
+    /** Service components. Components registered before start() returns
+     *  are started right after it on a dedicated startup pool (so their
+     *  start functions are free to wait for workers() tasks) and stopped
+     *  (before start()'s cleanup) when the service goes down. Component
+     *  failure terminates the service.
+     */
+    Components& components() { return components_; }
+
+    /** Warm-restart snapshot providers (enabled by service.snapshot).
+     *
+     *  Snapshot left by previous instance is mapped before start() and
+     *  consumed (file removed); providers registered during start() or
+     *  component startup are restored right at registration. Mapping is
+     *  released after startup unless held by a SnapshotReader. All
+     *  providers are saved when run() returns success.
+     */
+    Snapshots& snapshots() { return snapshots_; }
+
+    /** Runtime-tunable parameters, available via "list", "get" and "set"
+     *  ctrl commands (unless handled by ctrl()). Built-ins log.mask and
+     *  log.timePrecision are registered after configuration.
+     */
+    Tunables& tunables() { return tunables_; }
+
+    /** Root cancellation token, cancelled when termination is detected
+     *  (stop(), isRunning()). Derive child tokens for subsystems; checking
+     *  a token is much cheaper than isRunning().
+     */
+    const CancellationToken& cancellation() const { return cancellation_; }
+
     /** Adds/removes this process to list of processes that are mark global
      *  terminate flag on terminate signal. All other processes handle terminate
      *  signal locally.
      */
     void globalTerminate(bool value = true, long pid = 0);
 
+    /** Worker entry point, gets worker index, returns worker's exit code.
+     */
+    typedef std::function<int(unsigned int index)> WorkerEntry;
+
+    /** Forks given number of workers that share all memory loaded so far
+     *  copy-on-write. Must be called from start() or later in the main
+     *  process.
+     *
+     *  Only the calling thread survives fork, therefore forking is allowed
+     *  only while no other service thread exists: throws std::logic_error
+     *  when workers() or reactors() pool has been created or profiler is
+     *  running (ctrl thread is stopped over fork automatically). Fork
+     *  workers before using the pools.
+     *
+     *  Each worker runs entry(index) with thread id "worker<index>" and
+     *  terminates via _exit(2) with returned code; this function returns
+     *  only in the main process. Workers are registered for global
+     *  termination and are stopped and reaped when run() returns.
+     *
+     *  Returns pids of forked workers.
+     */
+    std::vector< ::pid_t> forkWorkers(unsigned int count
+                                      , const WorkerEntry &entry);
+
+    /** Service-wide work-stealing thread pool, created on first use. Must
+     *  be called from start() or later.
+     *
+     *  Pool size is given by service.threads (defaults to number of CPUs the
+     *  service is allowed to run on). Pool keeps running until components
+     *  are stopped after run() returns (components may still need it while
+     *  stopping); then queued tasks are cancelled and threads joined, before
+     *  start()'s cleanup is destroyed.
+     *  Pool statistics are appended to the stat output.
+     */
+    Executor& workers();
+
+    /** Service-wide pool of asio reactors, created on first use. Must be
+     *  called from start() or later.
+     *
+     *  Pool size is given by service.reactors (defaults to number of CPUs
+     *  the service is allowed to run on), reactors are pinned when
+     *  service.pinReactors is set. Reactors are stopped and joined together
+     *  with workers(), after components are stopped. Load and
+     *  timer lag (see ReactorPool) of each reactor is appended to the
+     *  monitor output.
+     */
+    ReactorPool& reactors();
+
+    /** Pins calling thread to one of CPUs the service is allowed to run on
+     *  (round-robin by index). Returns selected CPU.
+     */
+    int pinThread(unsigned int index);
+
     struct Config {
         std::string username;
         std::string groupname;
         bool loginEnv = false;
 
+        /** Placement, applied before start().
+         */
+        std::string cpuAffinity;
+        std::string numaPolicy;
+        std::string numaNode;
+        bool pinWorkers = false;
+
+        /** Size of workers() pool, 0 means number of allowed CPUs.
+         */
+        unsigned int threads = 0;
+
+        /** Size of reactors() pool, 0 means number of allowed CPUs.
+         */
+        unsigned int reactors = 0;
+        bool pinReactors = false;
+
+        /** Skip cleanup on shutdown, see Service::fastExit().
+         */
+        bool fastExit = false;
+
+        /** Snapshot file, empty to disable snapshots.
+         */
+        boost::filesystem::path snapshot;
+        long snapshotMaxAge = 0;
+
         Config() {}
 
         void configuration(po::options_description &cmdline
@@ -157,11 +279,88 @@ private:
      */
     void logRotate();
 
+    /** Stops and reaps all forked workers.
+     */
+    void reapWorkers();
+
+    /** Ordered teardown: stops components (in parallel, with deadlines),
+     *  pools and workers, saves snapshot (if asked to) and destroys
+     *  start()'s cleanup, logging duration of each phase. Fast mode does not
+     *  join pools and keeps cleanup.
+     */
+    void shutdown(Cleanup &cleanup, bool fast, bool snapshot);
+
+    /** Shuts down in fast mode, removes ctrl socket and pid file and
+     *  terminates the process via _exit(2) without freeing memory.
+     */
+    [[noreturn]] void fastExit(Cleanup &cleanup, int code
+                               , const boost::filesystem::path &pidFile);
+
+    /** Opens snapshot left by previous instance.
+     */
+    void openSnapshot(long maxAge);
+
+    /** Saves snapshot on graceful stop.
+     */
+    void saveSnapshot();
+
+    /** Cancels queued work of workers() pool and stops reactors() (if
+     *  any), optionally joins their threads.
+     */
+    void stopPools(bool join);
+
+    void executorStat(std::ostream &output);
+
+    /** Handles "profile" ctrl command.
+     */
+    void profileCtrl(const CtrlCommand &cmd, std::ostream &output);
+
+    /** Registers built-in tunables.
+     */
+    void builtinTunables(const po::variables_map &vm);
+
+    /** Handles "list", "get" and "set" ctrl commands. Returns false if
+     *  command is not one of them.
+     */
+    bool tunablesCtrl(const CtrlCommand &cmd, std::ostream &output);
+
     bool daemonize_;
 
     boost::optional<Persona> persona_;
 
     std::shared_ptr<detail::SignalHandler> signalHandler_;
+
+    struct Worker {
+        unsigned int index;
+        ::pid_t pid;
+    };
+
+    std::shared_ptr<detail::MallocConfig> mallocConfig_;
+    std::shared_ptr<detail::UsageMonitor> usage_;
+
+    ::pid_t mainPid_;
+    CpuList cpus_;
+    bool pinWorkers_;
+    std::mutex workersMutex_;
+    std::vector<Worker> workers_;
+    unsigned int nextWorkerIndex_;
+
+    unsigned int threads_;
+    unsigned int reactorCount_;
+    bool pinReactors_;
+    bool fastExit_;
+    std::mutex poolsMutex_;
+    std::unique_ptr<Executor> executor_;
+    std::unique_ptr<ReactorPool> reactors_;
+
+    CancellationToken cancellation_;
+    Components components_;
+
+    Snapshots snapshots_;
+    boost::filesystem::path snapshotPath_;
+
+    Tunables tunables_;
+    std::atomic<unsigned short> logTimePrecision_;
 };
 
 } // namespace service
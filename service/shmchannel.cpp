@@ -0,0 +1,325 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <system_error>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#include "dbglog/dbglog.hpp"
+
+#include "shmchannel.hpp"
+#include "detail/sharedmemory.hpp"
+
+namespace service {
+
+namespace {
+
+constexpr std::size_t CacheLineSize = 64;
+
+struct alignas(CacheLineSize) CacheLine { char data[CacheLineSize]; };
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free
+              , "Shared memory channel needs address-free 64-bit atomics.");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free
+              , "Shared memory channel needs address-free 32-bit atomics.");
+
+/** Shared control block, each counter in its own cache line.
+ */
+struct Control {
+    alignas(CacheLineSize) std::atomic<std::uint64_t> enqueue;
+    alignas(CacheLineSize) std::atomic<std::uint64_t> dequeue;
+    alignas(CacheLineSize) std::atomic<std::uint32_t> waiting;
+
+    Control() : enqueue(0), dequeue(0), waiting(0) {}
+};
+
+struct SlotHeader {
+    std::atomic<std::uint64_t> sequence;
+    std::uint32_t type;
+    std::uint32_t size;
+};
+
+constexpr int SpinCount = 1000;
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+std::size_t roundUp(std::size_t value, std::size_t to)
+{
+    return ((value + to - 1) / to) * to;
+}
+
+std::size_t powerOfTwo(std::size_t value)
+{
+    std::size_t out(1);
+    while (out < value) { out <<= 1; }
+    return out;
+}
+
+} // namespace
+
+struct ShmChannel::Detail {
+    Detail(const Params &params)
+        : capacity(powerOfTwo(std::max(params.capacity, std::size_t(2))))
+        , mask(capacity - 1), messageSize(params.messageSize)
+        , stride(roundUp(sizeof(SlotHeader) + messageSize, CacheLineSize))
+        , mem(sizeof(Control) + capacity * stride + 2 * CacheLineSize)
+        , control(new (mem.get<Control>()) Control())
+        , slots(reinterpret_cast<char*>
+                (mem.get<CacheLine>(capacity * stride / CacheLineSize)))
+        , efd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+        , spin((std::thread::hardware_concurrency() > 1) ? SpinCount : 0)
+    {
+        if (-1 == efd) {
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Failed to create channel eventfd: <"
+                      << e.what() << ">.";
+            throw e;
+        }
+
+        for (std::size_t i(0); i < capacity; ++i) {
+            new (&slot(i)) SlotHeader();
+            slot(i).sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~Detail() { ::close(efd); }
+
+    SlotHeader& slot(std::uint64_t pos) {
+        return *reinterpret_cast<SlotHeader*>(slots + (pos & mask) * stride);
+    }
+
+    char* payload(SlotHeader &s) {
+        return reinterpret_cast<char*>(&s) + sizeof(SlotHeader);
+    }
+
+    bool push(std::uint32_t type, const void *data, std::size_t size);
+    bool tryPop(std::uint32_t &type, std::string &data);
+    void notify();
+    bool arm();
+    void drain();
+    bool wait(Timeout timeout);
+
+    const std::size_t capacity;
+    const std::uint64_t mask;
+    const std::size_t messageSize;
+    const std::size_t stride;
+    detail::Allocator mem;
+    Control *control;
+    char *slots;
+    int efd;
+
+    /** Spinning makes sense only when producer can run in parallel.
+     */
+    const int spin;
+};
+
+bool ShmChannel::Detail::push(std::uint32_t type, const void *data
+                              , std::size_t size)
+{
+    auto pos(control->enqueue.load(std::memory_order_relaxed));
+    SlotHeader *s;
+    for (;;) {
+        s = &slot(pos);
+        const auto seq(s->sequence.load(std::memory_order_acquire));
+        const auto diff(std::int64_t(seq) - std::int64_t(pos));
+        if (!diff) {
+            if (control->enqueue.compare_exchange_weak
+                (pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        } else if (diff < 0) {
+            // full
+            return false;
+        } else {
+            pos = control->enqueue.load(std::memory_order_relaxed);
+        }
+    }
+
+    s->type = type;
+    s->size = size;
+    std::memcpy(payload(*s), data, size);
+    s->sequence.store(pos + 1, std::memory_order_release);
+
+    notify();
+    return true;
+}
+
+void ShmChannel::Detail::notify()
+{
+    // pairs with fence in wait(): either consumer sees our message or we see
+    // its waiting flag
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!control->waiting.load(std::memory_order_relaxed)) { return; }
+
+    const std::uint64_t one(1);
+    while ((-1 == ::write(efd, &one, sizeof(one))) && (EINTR == errno));
+}
+
+bool ShmChannel::Detail::tryPop(std::uint32_t &type, std::string &data)
+{
+    // single consumer -> no CAS needed
+    const auto pos(control->dequeue.load(std::memory_order_relaxed));
+    auto &s(slot(pos));
+    const auto seq(s.sequence.load(std::memory_order_acquire));
+    if (seq != (pos + 1)) { return false; }
+
+    type = s.type;
+    data.assign(payload(s), s.size);
+
+    control->dequeue.store(pos + 1, std::memory_order_relaxed);
+    s.sequence.store(pos + capacity, std::memory_order_release);
+    return true;
+}
+
+bool ShmChannel::Detail::arm()
+{
+    drain();
+
+    control->waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // re-check after announcing sleep
+    const auto pos(control->dequeue.load(std::memory_order_relaxed));
+    return (slot(pos).sequence.load(std::memory_order_acquire) != (pos + 1));
+}
+
+void ShmChannel::Detail::drain()
+{
+    std::uint64_t value;
+    while ((-1 == ::read(efd, &value, sizeof(value))) && (EINTR == errno));
+}
+
+bool ShmChannel::Detail::wait(Timeout timeout)
+{
+    bool ready(!arm());
+
+    if (!ready) {
+        ::pollfd pfd{ efd, POLLIN, 0 };
+        auto r(::poll(&pfd, 1, int(timeout.count())));
+        if ((-1 == r) && (EINTR != errno)) {
+            control->waiting.store(0, std::memory_order_relaxed);
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Failed to wait for channel eventfd: <"
+                      << e.what() << ">.";
+            throw e;
+        }
+        ready = (r > 0);
+    }
+
+    control->waiting.store(0, std::memory_order_relaxed);
+    return ready;
+}
+
+ShmChannel::ShmChannel(const Params &params)
+    : detail_(new Detail(params))
+{}
+
+ShmChannel::~ShmChannel() {}
+
+bool ShmChannel::push(std::uint32_t type, const void *data, std::size_t size)
+{
+    if (size > detail().messageSize) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Channel message too large (" << size << " > "
+            << detail().messageSize << ").";
+    }
+
+    return detail().push(type, data, size);
+}
+
+bool ShmChannel::pop(std::uint32_t &type, std::string &data, Timeout timeout)
+{
+    auto &d(detail());
+    if (d.tryPop(type, data)) { return true; }
+    if (!timeout.count()) { return false; }
+
+    // short spin before going to sleep: producer is likely mid-burst
+    for (int i(0); i < d.spin; ++i) {
+        cpuRelax();
+        if (d.tryPop(type, data)) { return true; }
+    }
+
+    const bool forever(timeout.count() < 0);
+    const auto deadline(std::chrono::steady_clock::now() + timeout);
+
+    for (;;) {
+        Timeout remaining(-1);
+        if (!forever) {
+            remaining = std::max
+                (Timeout(), std::chrono::duration_cast<Timeout>
+                 (deadline - std::chrono::steady_clock::now()));
+        }
+
+        d.wait(remaining);
+        if (d.tryPop(type, data)) { return true; }
+        if (!forever && (std::chrono::steady_clock::now() >= deadline)) {
+            return false;
+        }
+    }
+}
+
+int ShmChannel::fd() const
+{
+    return detail().efd;
+}
+
+bool ShmChannel::arm()
+{
+    return detail().arm();
+}
+
+std::size_t ShmChannel::size() const
+{
+    const auto &control(*detail().control);
+    const auto enqueue(control.enqueue.load(std::memory_order_relaxed));
+    const auto dequeue(control.dequeue.load(std::memory_order_relaxed));
+    return (enqueue > dequeue) ? (enqueue - dequeue) : 0;
+}
+
+std::size_t ShmChannel::capacity() const
+{
+    return detail().capacity;
+}
+
+std::size_t ShmChannel::messageSize() const
+{
+    return detail().messageSize;
+}
+
+} // namespace service
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_shmchannel_hpp_included_
+#define service_shmchannel_hpp_included_
+
+#include <string>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+
+namespace service {
+
+/** Bounded lock-free message queue in anonymous shared memory.
+ *
+ *  Must be created before fork; any number of processes (and threads) may
+ *  push, exactly one process may pop. Use one channel per direction: e.g. a
+ *  single workers->master channel and one master->worker channel per worker.
+ *
+ *  Messages are copied into fixed-size slots (up to Params::messageSize
+ *  bytes). Consumer sleeps on an eventfd; producers write to it only when
+ *  the consumer announced it is going to sleep, therefore busy channels do
+ *  not make any syscall per message.
+ *
+ *  NB: producer killed in the middle of push() stalls the channel.
+ */
+class ShmChannel {
+public:
+    struct Params {
+        /** Number of slots, rounded up to power of two.
+         */
+        std::size_t capacity;
+
+        /** Maximum message payload size.
+         */
+        std::size_t messageSize;
+
+        Params() : capacity(1024), messageSize(240) {}
+    };
+
+    /** Negative timeout means wait forever, zero means do not wait at all.
+     */
+    typedef std::chrono::milliseconds Timeout;
+
+    ShmChannel(const Params &params = Params());
+
+    ~ShmChannel();
+
+    /** Pushes message into the channel. Never blocks.
+     *
+     *  Returns false if the channel is full. Throws if message is too large.
+     */
+    bool push(std::uint32_t type, const void *data, std::size_t size);
+
+    bool push(std::uint32_t type, const std::string &data) {
+        return push(type, data.data(), data.size());
+    }
+
+    /** Pops message from the channel, waits at most given timeout. Message
+     *  payload is assigned to data (to reuse its capacity).
+     *
+     *  Returns false on timeout.
+     */
+    bool pop(std::uint32_t &type, std::string &data
+             , Timeout timeout = Timeout(-1));
+
+    /** Eventfd signalled when armed consumer has new data. Usable for
+     *  integration into poll/asio loop: call arm() and wait for fd() only if
+     *  it returned true; after wake up call pop() with zero timeout until it
+     *  returns false and arm again.
+     */
+    int fd() const;
+
+    /** Announces that the consumer is going to wait for fd().
+     *  Returns false if there are messages available (i.e. do not wait).
+     */
+    bool arm();
+
+    /** Approximate number of queued messages.
+     */
+    std::size_t size() const;
+
+    std::size_t capacity() const;
+
+    std::size_t messageSize() const;
+
+    struct Detail;
+
+private:
+    std::unique_ptr<Detail> detail_;
+    Detail& detail() { return *detail_; }
+    const Detail& detail() const { return *detail_; }
+};
+
+} // namespace service
+
+#endif // service_shmchannel_hpp_included_
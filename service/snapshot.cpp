@@ -0,0 +1,565 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <system_error>
+
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "snapshot.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace service {
+
+namespace {
+
+const char Magic[8] = { 'S', 'V', 'C', 'S', 'N', 'A', 'P', '\0' };
+
+constexpr std::uint32_t Format = 1;
+
+/** Section data alignment.
+ */
+constexpr std::size_t Alignment = 64;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t format;
+    /** CRC32 of identity string.
+     */
+    std::uint32_t identity;
+    std::uint64_t created;
+    std::uint64_t tableOffset;
+    std::uint32_t sections;
+    /** CRC32 of header (with zero crc) and section table.
+     */
+    std::uint32_t crc;
+};
+
+struct TableEntry {
+    char name[Snapshots::MaxNameSize + 1];
+    std::uint32_t version;
+    std::uint32_t crc;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+std::uint32_t crc32(const void *data, std::size_t size)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+std::uint32_t tableCrc(FileHeader header, const TableEntry *table)
+{
+    header.crc = 0;
+    boost::crc_32_type crc;
+    crc.process_bytes(&header, sizeof(header));
+    crc.process_bytes(table, header.sections * sizeof(TableEntry));
+    return crc.checksum();
+}
+
+} // namespace
+
+struct SnapshotWriter::Detail {
+    Detail(const fs::path &path);
+    ~Detail();
+
+    void write(const void *data, std::size_t size);
+    void align();
+    void flush();
+
+    /** Writes data directly to the file.
+     */
+    void writeFile(const char *data, std::size_t size);
+
+    fs::path path;
+    int fd;
+    std::vector<char> buffer;
+    std::uint64_t offset;
+    boost::crc_32_type crc;
+};
+
+SnapshotWriter::Detail::Detail(const fs::path &path)
+    : path(path)
+    , fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC
+                , S_IRUSR | S_IWUSR))
+    , offset()
+{
+    if (fd == -1) {
+        std::system_error e(errno, std::system_category());
+        LOG(err3) << "Cannot create snapshot file " << path << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+    buffer.reserve(1 << 20);
+}
+
+SnapshotWriter::Detail::~Detail()
+{
+    if (fd != -1) { ::close(fd); }
+}
+
+void SnapshotWriter::Detail::write(const void *data, std::size_t size)
+{
+    crc.process_bytes(data, size);
+    offset += size;
+
+    if ((buffer.size() + size) > buffer.capacity()) { flush(); }
+    if (size >= buffer.capacity()) {
+        // large block, bypass buffer
+        writeFile(static_cast<const char*>(data), size);
+        return;
+    }
+
+    buffer.insert(buffer.end(), static_cast<const char*>(data)
+                  , static_cast<const char*>(data) + size);
+}
+
+void SnapshotWriter::Detail::align()
+{
+    static const char zeros[Alignment] = { 0 };
+    if (const auto pad = (Alignment - (offset % Alignment)) % Alignment) {
+        write(zeros, pad);
+    }
+}
+
+void SnapshotWriter::Detail::flush()
+{
+    writeFile(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void SnapshotWriter::Detail::writeFile(const char *data, std::size_t size)
+{
+    auto left(size);
+    while (left) {
+        const auto written(::write(fd, data, left));
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            std::system_error e(errno, std::system_category());
+            LOG(err3) << "Cannot write snapshot file " << path << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+        data += written;
+        left -= written;
+    }
+}
+
+void SnapshotWriter::write(const void *data, std::size_t size)
+{
+    detail_.write(data, size);
+    size_ += size;
+}
+
+void SnapshotWriter::write(const std::string &value)
+{
+    write(std::uint64_t(value.size()));
+    write(value.data(), value.size());
+}
+
+const void* SnapshotReader::read(std::size_t size)
+{
+    if (size > remaining()) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Snapshot section overrun: need " << size
+            << " bytes, " << remaining() << " left.";
+    }
+    const auto data(data_ + offset_);
+    offset_ += size;
+    return data;
+}
+
+std::string SnapshotReader::readString()
+{
+    const auto size(read<std::uint64_t>());
+    const auto data(static_cast<const char*>(read(size)));
+    return std::string(data, data + size);
+}
+
+struct Snapshot::Detail {
+    std::shared_ptr<const void> mapping;
+    const char *data;
+    const FileHeader *header;
+    const TableEntry *table;
+
+    /** Lazy checksum verification: 0 = not yet, 1 = valid, -1 = invalid.
+     */
+    mutable std::mutex mutex;
+    mutable std::vector<int> verified;
+};
+
+Snapshot::Snapshot(std::unique_ptr<Detail> &&detail)
+    : detail_(std::move(detail))
+{}
+
+Snapshot::~Snapshot() {}
+
+Snapshot::pointer Snapshot::open(const fs::path &path
+                                 , const std::string &identity
+                                 , std::time_t maxAge)
+{
+    const auto fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd == -1) {
+        if (errno == ENOENT) {
+            LOG(info3) << "No snapshot at " << path << ".";
+        } else {
+            std::system_error e(errno, std::system_category());
+            LOG(warn3) << "Cannot open snapshot " << path << ": <"
+                       << e.code() << ", " << e.what() << ">.";
+        }
+        return {};
+    }
+
+    struct ::stat st;
+    if ((-1 == ::fstat(fd, &st))
+        || (std::size_t(st.st_size) < sizeof(FileHeader)))
+    {
+        ::close(fd);
+        LOG(warn3) << "Snapshot " << path << " is truncated, ignored.";
+        return {};
+    }
+
+    const std::size_t size(st.st_size);
+    auto addr(::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::system_error e(errno, std::system_category());
+        LOG(warn3) << "Cannot map snapshot " << path << ": <"
+                   << e.code() << ", " << e.what() << ">.";
+        return {};
+    }
+
+    std::unique_ptr<Detail> detail(new Detail());
+    detail->mapping.reset(addr, [size](const void *addr) {
+            ::munmap(const_cast<void*>(addr), size);
+        });
+    detail->data = static_cast<const char*>(addr);
+    detail->header = static_cast<const FileHeader*>(addr);
+
+    const auto &header(*detail->header);
+    const auto invalid([&](const char *why) -> pointer {
+        LOG(warn3) << "Snapshot " << path << " ignored: " << why << ".";
+        return {};
+    });
+
+    if (std::memcmp(header.magic, Magic, sizeof(Magic))) {
+        return invalid("not a snapshot file");
+    }
+    if (header.format != Format) {
+        return invalid("unsupported format");
+    }
+    if ((header.tableOffset > size)
+        || (header.sections
+            > ((size - header.tableOffset) / sizeof(TableEntry))))
+    {
+        return invalid("truncated");
+    }
+
+    detail->table = reinterpret_cast<const TableEntry*>
+        (detail->data + header.tableOffset);
+    if (tableCrc(header, detail->table) != header.crc) {
+        return invalid("header checksum mismatch");
+    }
+    if (header.identity != crc32(identity.data(), identity.size())) {
+        return invalid("written by different program version");
+    }
+
+    const auto now(std::time(nullptr));
+    if (maxAge && ((now - std::time_t(header.created)) > maxAge)) {
+        return invalid("too old");
+    }
+
+    for (std::uint32_t i(0); i < header.sections; ++i) {
+        const auto &entry(detail->table[i]);
+        if ((entry.offset > header.tableOffset)
+            || (entry.size > (header.tableOffset - entry.offset)))
+        {
+            return invalid("section out of bounds");
+        }
+    }
+
+    detail->verified.resize(header.sections);
+
+    LOG(info3) << "Mapped snapshot " << path << " with "
+               << header.sections << " sections, "
+               << (now - std::time_t(header.created)) << " s old.";
+
+    return std::make_shared<Snapshot>(std::move(detail));
+}
+
+boost::optional<SnapshotReader>
+Snapshot::section(const std::string &name, std::uint32_t version) const
+{
+    const auto &d(detail());
+    for (std::uint32_t i(0); i < d.header->sections; ++i) {
+        const auto &entry(d.table[i]);
+        if (std::strncmp(entry.name, name.c_str(), sizeof(entry.name))) {
+            continue;
+        }
+
+        if (entry.version != version) {
+            LOG(info3) << "Snapshot section <" << name << "> has version "
+                       << entry.version << ", expected " << version
+                       << "; ignored.";
+            return boost::none;
+        }
+
+        const auto data(d.data + entry.offset);
+        {
+            std::lock_guard<std::mutex> guard(d.mutex);
+            auto &verified(d.verified[i]);
+            if (!verified) {
+                verified = (crc32(data, entry.size) == entry.crc) ? 1 : -1;
+            }
+            if (verified < 0) {
+                LOG(warn3) << "Snapshot section <" << name
+                           << "> is corrupted; ignored.";
+                return boost::none;
+            }
+        }
+
+        return SnapshotReader(d.mapping, data, entry.size, entry.version);
+    }
+
+    return boost::none;
+}
+
+std::vector<std::string> Snapshot::sections() const
+{
+    std::vector<std::string> names;
+    for (std::uint32_t i(0); i < detail().header->sections; ++i) {
+        names.emplace_back(detail().table[i].name);
+    }
+    return names;
+}
+
+std::time_t Snapshot::created() const
+{
+    return detail().header->created;
+}
+
+namespace {
+
+void loadProvider(const Snapshot &snapshot, const std::string &name
+                  , std::uint32_t version, const Snapshots::Load &load)
+{
+    auto reader(snapshot.section(name, version));
+    if (!reader) { return; }
+
+    const auto start(std::chrono::steady_clock::now());
+    try {
+        load(*reader);
+    } catch (const std::exception &e) {
+        LOG(warn3) << "Cannot restore <" << name << "> from snapshot: <"
+                   << e.what() << ">.";
+        return;
+    }
+    LOG(info3) << "Restored <" << name << "> from snapshot in "
+               << std::chrono::duration_cast<std::chrono::milliseconds>
+               (std::chrono::steady_clock::now() - start).count()
+               << " ms.";
+}
+
+} // namespace
+
+struct Snapshots::Detail {
+    struct Provider {
+        std::string name;
+        std::uint32_t version;
+        Save save;
+        Load load;
+        /** Load has been offered a snapshot already.
+         */
+        bool restored;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Provider> providers;
+    Snapshot::pointer snapshot;
+};
+
+constexpr std::size_t Snapshots::MaxNameSize;
+
+Snapshots::Snapshots() : detail_(new Detail()) {}
+
+Snapshots::~Snapshots() {}
+
+void Snapshots::add(const std::string &name, std::uint32_t version
+                    , const Save &save, const Load &load)
+{
+    if (name.empty() || (name.size() > MaxNameSize)) {
+        LOGTHROW(err3, std::logic_error)
+            << "Invalid snapshot provider name <" << name << ">.";
+    }
+
+    Snapshot::pointer snapshot;
+    {
+        auto &d(detail());
+        std::lock_guard<std::mutex> guard(d.mutex);
+        for (const auto &provider : d.providers) {
+            if (provider.name == name) {
+                LOGTHROW(err3, std::logic_error)
+                    << "Snapshot provider <" << name
+                    << "> already registered.";
+            }
+        }
+        snapshot = d.snapshot;
+        d.providers.push_back({ name, version, save, load, bool(snapshot) });
+    }
+
+    if (snapshot && load) { loadProvider(*snapshot, name, version, load); }
+}
+
+bool Snapshots::empty() const
+{
+    std::lock_guard<std::mutex> guard(detail().mutex);
+    return detail().providers.empty();
+}
+
+void Snapshots::restore(const Snapshot::pointer &snapshot)
+{
+    // providers registered before snapshot was available
+    std::vector<Detail::Provider> pending;
+    {
+        auto &d(detail());
+        std::lock_guard<std::mutex> guard(d.mutex);
+        d.snapshot = snapshot;
+        if (!snapshot) { return; }
+        for (auto &provider : d.providers) {
+            if (provider.restored) { continue; }
+            provider.restored = true;
+            if (provider.load) { pending.push_back(provider); }
+        }
+    }
+
+    // outside the lock, loaders may register other providers
+    for (const auto &provider : pending) {
+        loadProvider(*snapshot, provider.name, provider.version
+                     , provider.load);
+    }
+}
+
+Snapshot::pointer Snapshots::snapshot() const
+{
+    std::lock_guard<std::mutex> guard(detail().mutex);
+    return detail().snapshot;
+}
+
+void Snapshots::save(const fs::path &path, const std::string &identity)
+    const
+{
+    std::vector<Detail::Provider> providers;
+    {
+        std::lock_guard<std::mutex> guard(detail().mutex);
+        providers = detail().providers;
+    }
+
+    const auto start(std::chrono::steady_clock::now());
+    auto tmp(path);
+    tmp += ".tmp";
+
+    try {
+        SnapshotWriter::Detail w(tmp);
+
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        w.write(&header, sizeof(header));
+
+        std::vector<TableEntry> table;
+        for (const auto &provider : providers) {
+            w.align();
+
+            TableEntry entry;
+            std::memset(&entry, 0, sizeof(entry));
+            std::strncpy(entry.name, provider.name.c_str()
+                         , sizeof(entry.name) - 1);
+            entry.version = provider.version;
+            entry.offset = w.offset;
+
+            w.crc.reset();
+            SnapshotWriter writer(w);
+            provider.save(writer);
+            entry.size = writer.size();
+            entry.crc = w.crc.checksum();
+
+            LOG(info2) << "Snapshot section <" << provider.name << ">: "
+                       << entry.size << " bytes.";
+            table.push_back(entry);
+        }
+
+        w.align();
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.format = Format;
+        header.identity = crc32(identity.data(), identity.size());
+        header.created = std::time(nullptr);
+        header.tableOffset = w.offset;
+        header.sections = table.size();
+        header.crc = tableCrc(header, table.data());
+
+        w.write(table.data(), table.size() * sizeof(TableEntry));
+        w.flush();
+
+        if (-1 == ::pwrite(w.fd, &header, sizeof(header), 0)) {
+            std::system_error e(errno, std::system_category());
+            LOG(err3) << "Cannot write snapshot file " << tmp << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+
+        if (-1 == ::fsync(w.fd)) {
+            std::system_error e(errno, std::system_category());
+            LOG(err3) << "Cannot sync snapshot file " << tmp << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+    } catch (...) {
+        boost::system::error_code ec;
+        fs::remove(tmp, ec);
+        throw;
+    }
+
+    fs::rename(tmp, path);
+
+    LOG(info3) << "Snapshot " << path << " with " << providers.size()
+               << " sections written in "
+               << std::chrono::duration_cast<std::chrono::milliseconds>
+               (std::chrono::steady_clock::now() - start).count() << " ms.";
+}
+
+} // namespace service
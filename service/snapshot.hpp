@@ -0,0 +1,207 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_snapshot_hpp_included_
+#define service_snapshot_hpp_included_
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
+
+namespace service {
+
+/** Sequential writer of one snapshot section.
+ */
+class SnapshotWriter {
+public:
+    void write(const void *data, std::size_t size);
+
+    template <typename T> void write(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value
+                      , "Only trivially copyable types can be written.");
+        write(&value, sizeof(value));
+    }
+
+    /** Writes size-prefixed string.
+     */
+    void write(const std::string &value);
+
+    /** Number of bytes written to this section so far.
+     */
+    std::size_t size() const { return size_; }
+
+    struct Detail;
+
+private:
+    friend class Snapshots;
+    SnapshotWriter(Detail &detail) : detail_(detail), size_() {}
+
+    Detail &detail_;
+    std::size_t size_;
+};
+
+/** Sequential zero-copy reader of one snapshot section. Keeps the snapshot
+ *  mapped while alive. Reading past section end throws std::runtime_error.
+ */
+class SnapshotReader {
+public:
+    /** Returns pointer to next size bytes (in mapped memory) and skips them.
+     */
+    const void* read(std::size_t size);
+
+    template <typename T> T read() {
+        static_assert(std::is_trivially_copyable<T>::value
+                      , "Only trivially copyable types can be read.");
+        T value;
+        std::memcpy(&value, read(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    /** Reads size-prefixed string.
+     */
+    std::string readString();
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    std::size_t remaining() const { return size_ - offset_; }
+
+    /** Version of provider that wrote this section.
+     */
+    std::uint32_t version() const { return version_; }
+
+private:
+    friend class Snapshot;
+    SnapshotReader(const std::shared_ptr<const void> &mapping
+                   , const char *data, std::size_t size
+                   , std::uint32_t version)
+        : mapping_(mapping), data_(data), size_(size), offset_()
+        , version_(version)
+    {}
+
+    std::shared_ptr<const void> mapping_;
+    const char *data_;
+    std::size_t size_;
+    std::size_t offset_;
+    std::uint32_t version_;
+};
+
+/** Memory-mapped snapshot file.
+ *
+ *  File is written by Snapshots::save(): header, sections (64-byte
+ *  aligned) and a section table. Header and table are checksummed and
+ *  verified on open; section checksum is verified lazily on first access.
+ */
+class Snapshot {
+public:
+    typedef std::shared_ptr<Snapshot> pointer;
+
+    /** Opens and maps snapshot file. Returns null pointer (and logs why) if
+     *  the file does not exist, is corrupted, was written by different
+     *  identity (program name and version) or is older than maxAge seconds
+     *  (unless zero).
+     */
+    static pointer open(const boost::filesystem::path &path
+                        , const std::string &identity
+                        , std::time_t maxAge = 0);
+
+    /** Returns reader of given section, none if there is no such section,
+     *  it has different version or its checksum does not match.
+     */
+    boost::optional<SnapshotReader> section(const std::string &name
+                                            , std::uint32_t version) const;
+
+    std::vector<std::string> sections() const;
+
+    std::time_t created() const;
+
+    struct Detail;
+
+    Snapshot(std::unique_ptr<Detail> &&detail);
+    ~Snapshot();
+
+private:
+    std::unique_ptr<Detail> detail_;
+    Detail& detail() { return *detail_; }
+    const Detail& detail() const { return *detail_; }
+};
+
+/** Registry of snapshot providers.
+ *
+ *  Provider is identified by its name (up to MaxNameSize characters) and
+ *  format version. When a snapshot is restored, provider's load is called
+ *  right at registration (in registering thread) if the snapshot contains
+ *  matching section. Providers registered before the snapshot is set are
+ *  loaded by restore() (in its thread). Each provider is loaded at most once.
+ */
+class Snapshots {
+public:
+    typedef std::function<void(SnapshotWriter &writer)> Save;
+    typedef std::function<void(SnapshotReader &reader)> Load;
+
+    static constexpr std::size_t MaxNameSize = 47;
+
+    Snapshots();
+    ~Snapshots();
+
+    void add(const std::string &name, std::uint32_t version
+             , const Save &save, const Load &load = Load());
+
+    bool empty() const;
+
+    /** Sets snapshot used by add() and loads providers registered so far.
+     *  Pass null pointer to release it.
+     */
+    void restore(const Snapshot::pointer &snapshot);
+
+    /** Current snapshot, null if none.
+     */
+    Snapshot::pointer snapshot() const;
+
+    /** Writes all providers into given file (via temporary file and
+     *  rename).
+     */
+    void save(const boost::filesystem::path &path
+              , const std::string &identity) const;
+
+    struct Detail;
+
+private:
+    std::unique_ptr<Detail> detail_;
+    Detail& detail() { return *detail_; }
+    const Detail& detail() const { return *detail_; }
+};
+
+} // namespace service
+
+#endif // service_snapshot_hpp_included_
@@ -0,0 +1,271 @@
+#define BOOST_TEST_MODULE components
+#include <boost/test/included/unit_test.hpp>
+
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <algorithm>
+
+#include "service/components.hpp"
+
+using service::Components;
+using service::Executor;
+using service::CancellationToken;
+
+namespace {
+
+/** Thread-safe record of start/stop events.
+ */
+struct Journal {
+    void operator()(const std::string &event) {
+        std::lock_guard<std::mutex> guard(mutex);
+        events.push_back(event);
+    }
+
+    std::size_t position(const std::string &event) const {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto fevents(std::find(events.begin(), events.end(), event));
+        BOOST_REQUIRE_MESSAGE(fevents != events.end()
+                              , "missing event " << event);
+        return fevents - events.begin();
+    }
+
+    bool has(const std::string &event) const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return std::find(events.begin(), events.end(), event) != events.end();
+    }
+
+    mutable std::mutex mutex;
+    std::vector<std::string> events;
+};
+
+void add(Components &components, Journal &journal, const std::string &name
+         , const std::vector<std::string> &dependencies
+         , const Components::Start &start = Components::Start())
+{
+    components.add(name, dependencies
+                   , [&journal, name, start](const CancellationToken &token)
+                   {
+                       if (start) { start(token); }
+                       journal("start " + name);
+                   }
+                   , [&journal, name]() { journal("stop " + name); });
+}
+
+std::string monitor(const Components &components)
+{
+    std::ostringstream os;
+    components.monitor(os);
+    return os.str();
+}
+
+bool contains(const std::string &haystack, const std::string &needle)
+{
+    return haystack.find(needle) != std::string::npos;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(startInDependencyOrderStopInReverse)
+{
+    Executor executor("test", 4);
+    CancellationToken token;
+    CancellationToken::Runnable runnable(token);
+    Journal journal;
+
+    //   a <- b <- c
+    //   a <- d
+    //   e (independent)
+    Components components;
+    add(components, journal, "c", { "b" });
+    add(components, journal, "b", { "a" });
+    add(components, journal, "d", { "a" });
+    add(components, journal, "a", {});
+    add(components, journal, "e", {});
+
+    components.start(executor, token, runnable);
+
+    BOOST_CHECK(journal.position("start a") < journal.position("start b"));
+    BOOST_CHECK(journal.position("start b") < journal.position("start c"));
+    BOOST_CHECK(journal.position("start a") < journal.position("start d"));
+    BOOST_CHECK(journal.has("start e"));
+
+    const auto status(monitor(components));
+    for (const auto &name : { "a", "b", "c", "d", "e" }) {
+        BOOST_CHECK(contains(status, std::string("Component-") + name
+                             + ": started"));
+    }
+
+    components.stop();
+
+    BOOST_CHECK(journal.position("stop c") < journal.position("stop b"));
+    BOOST_CHECK(journal.position("stop b") < journal.position("stop a"));
+    BOOST_CHECK(journal.position("stop d") < journal.position("stop a"));
+    BOOST_CHECK(journal.has("stop e"));
+    BOOST_CHECK(contains(monitor(components), "Component-a: stopped"));
+
+    // idempotent
+    components.stop();
+    BOOST_CHECK_EQUAL(journal.events.size(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(independentComponentsStartConcurrently)
+{
+    Executor executor("test", 2);
+    CancellationToken token;
+    CancellationToken::Runnable runnable(token);
+    Journal journal;
+
+    // each start waits for the other one: passes only when run in parallel
+    std::atomic<int> arrived(0);
+    auto rendezvous([&](const CancellationToken&) {
+        ++arrived;
+        while (arrived < 2) { std::this_thread::yield(); }
+    });
+
+    Components components;
+    add(components, journal, "a", {}, rendezvous);
+    add(components, journal, "b", {}, rendezvous);
+
+    components.start(executor, token, runnable);
+    BOOST_CHECK_EQUAL(arrived, 2);
+    components.stop();
+}
+
+BOOST_AUTO_TEST_CASE(unknownDependencyIsRejected)
+{
+    Executor executor("test", 1);
+    CancellationToken token;
+    CancellationToken::Runnable runnable(token);
+    Journal journal;
+
+    Components components;
+    add(components, journal, "a", { "missing" });
+
+    BOOST_CHECK_THROW(components.start(executor, token, runnable)
+                      , std::logic_error);
+    BOOST_CHECK(journal.events.empty());
+}
+
+BOOST_AUTO_TEST_CASE(dependencyCycleIsRejected)
+{
+    Executor executor("test", 1);
+    CancellationToken token;
+    CancellationToken::Runnable runnable(token);
+    Journal journal;
+
+    // root is fine, the rest forms a cycle a -> b -> c -> a
+    Components components;
+    add(components, journal, "root", {});
+    add(components, journal, "a", { "root", "c" });
+    add(components, journal, "b", { "a" });
+    add(components, journal, "c", { "b" });
+
+    BOOST_CHECK_THROW(components.start(executor, token, runnable)
+                      , std::logic_error);
+    BOOST_CHECK(journal.events.empty());
+}
+
+BOOST_AUTO_TEST_CASE(duplicateNameIsRejected)
+{
+    Journal journal;
+    Components components;
+    add(components, journal, "a", {});
+    BOOST_CHECK_THROW(add(components, journal, "a", {}), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(failurePropagatesAndStopsStartedComponents)
+{
+    Executor executor("test", 2);
+    CancellationToken token;
+    CancellationToken::Runnable runnable(token);
+    Journal journal;
+
+    // sibling blocks until startup token is cancelled by the failure
+    std::atomic<bool> siblingCancelled(false);
+    auto sibling([&](const CancellationToken &token) {
+        while (!token.cancelled()) { std::this_thread::yield(); }
+        siblingCancelled = true;
+    });
+
+    Components components;
+    add(components, journal, "a", {});
+    add(components, journal, "b", { "a" }, [](const CancellationToken&) {
+            throw std::runtime_error("boom");
+        });
+    add(components, journal, "c", { "b" });
+    add(components, journal, "s", { "a" }, sibling);
+
+    try {
+        components.start(executor, token, runnable);
+        BOOST_ERROR("start() did not throw");
+    } catch (const std::runtime_error &e) {
+        BOOST_CHECK_EQUAL(e.what(), std::string("boom"));
+    }
+
+    BOOST_CHECK(siblingCancelled);
+    BOOST_CHECK(!journal.has("start b"));
+    BOOST_CHECK(!journal.has("start c"));
+
+    // started components are stopped by failed start()
+    BOOST_CHECK(journal.has("stop a"));
+    BOOST_CHECK(journal.has("stop s"));
+    BOOST_CHECK(journal.position("stop s") < journal.position("stop a"));
+
+    const auto status(monitor(components));
+    BOOST_CHECK(contains(status, "Component-b: failed"));
+    BOOST_CHECK(contains(status, "(boom)"));
+    BOOST_CHECK(contains(status, "Component-c: skipped"));
+    BOOST_CHECK(contains(status, "Component-a: stopped"));
+}
+
+BOOST_AUTO_TEST_CASE(cancelledStartupThrows)
+{
+    Executor executor("test", 1);
+    CancellationToken token;
+    CancellationToken::Runnable runnable(token);
+    Journal journal;
+
+    Components components;
+    add(components, journal, "a", {}, [&](const CancellationToken&) {
+            token.cancel();
+        });
+    add(components, journal, "b", { "a" });
+
+    BOOST_CHECK_THROW(components.start(executor, token, runnable)
+                      , std::runtime_error);
+    BOOST_CHECK(!journal.has("start b"));
+    BOOST_CHECK(journal.has("stop a"));
+}
+
+BOOST_AUTO_TEST_CASE(stopDeadlineAbandonsComponent)
+{
+    Executor executor("test", 1);
+    CancellationToken token;
+    CancellationToken::Runnable runnable(token);
+
+    auto stuck(std::make_shared<std::atomic<bool>>(false));
+
+    Components components;
+    components.add("stuck", {}, Components::Start()
+                   , [stuck]() {
+                       while (!*stuck) {
+                           std::this_thread::sleep_for
+                               (std::chrono::milliseconds(10));
+                       }
+                   }
+                   , Components::Timeout(100));
+
+    components.start(executor, token, runnable);
+
+    const auto begin(std::chrono::steady_clock::now());
+    components.stop();
+    BOOST_CHECK(std::chrono::steady_clock::now() - begin
+                < std::chrono::seconds(5));
+    BOOST_CHECK(contains(monitor(components)
+                         , "Component-stuck: did not stop in time"));
+
+    // let the abandoned thread finish
+    *stuck = true;
+}
@@ -0,0 +1,309 @@
+#define BOOST_TEST_MODULE ctrlhandshake
+#include <boost/test/included/unit_test.hpp>
+
+#include <thread>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "service/ctrlhandshake.hpp"
+
+namespace ba = boost::algorithm;
+
+using service::CtrlSessionTokens;
+using service::CtrlServerHandshake;
+using service::CtrlClientHandshake;
+
+namespace {
+
+const std::string Secret("s3cret");
+
+boost::optional<std::string> lookup(const std::string &component)
+{
+    if (component == "comp") { return Secret; }
+    return boost::none;
+}
+
+std::vector<std::string> split(const std::string &line)
+{
+    std::vector<std::string> words;
+    ba::split(words, line, ba::is_any_of(" "));
+    return words;
+}
+
+std::string now(long offset = 0)
+{
+    return boost::lexical_cast<std::string>
+        (std::chrono::duration_cast<std::chrono::seconds>
+         (std::chrono::system_clock::now().time_since_epoch()).count()
+         + offset);
+}
+
+std::string resumeLine(const std::string &id, const std::string &nonce
+                       , const std::string &timestamp
+                       , const std::string &secret = Secret)
+{
+    const auto key(service::ctrlSessionKey(secret, "comp", id));
+    return "comp resume " + id + " " + nonce + " " + timestamp + " "
+        + service::ctrlResumeProof(key, "comp", id, nonce, timestamp);
+}
+
+/** Runs client against server, returns number of round trips.
+ */
+int converse(CtrlClientHandshake &client, CtrlServerHandshake &server)
+{
+    int trips(1);
+    auto line(client.start());
+    while (auto next = client.next({ server.process(line) })) {
+        line = *next;
+        ++trips;
+    }
+    return trips;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(hmac_sha256_rfc4231)
+{
+    // RFC 4231, test case 2
+    BOOST_CHECK_EQUAL(service::hmacSha256Hex
+                      ("Jefe", "what do ya want for nothing?")
+                      , "5bdcc146bf60754e6a042426089575c7"
+                      "5a003f089d2739839dec58b964ec3843");
+}
+
+BOOST_AUTO_TEST_CASE(challenge_is_random_hex)
+{
+    const auto a(service::ctrlChallenge());
+    const auto b(service::ctrlChallenge());
+    BOOST_CHECK_EQUAL(a.size(), 32u);
+    BOOST_CHECK(a.find_first_not_of("0123456789abcdef") == std::string::npos);
+    BOOST_CHECK_NE(a, b);
+}
+
+BOOST_AUTO_TEST_CASE(token_format)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+    const auto id(tokens.issue("comp"));
+
+    std::vector<std::string> parts;
+    ba::split(parts, id, ba::is_any_of("."));
+    BOOST_REQUIRE_EQUAL(parts.size(), 3u);
+
+    // expiry.nonce.mac
+    const auto expiry(boost::lexical_cast<long long>(parts[0]));
+    const auto expected(boost::lexical_cast<long long>(now(60)));
+    BOOST_CHECK(std::abs(expiry - expected) <= 1);
+    BOOST_CHECK_EQUAL(parts[1].size(), 16u);
+    BOOST_CHECK_EQUAL(parts[2].size(), 64u);
+
+    BOOST_CHECK(tokens.verify("comp", id));
+    BOOST_CHECK_NE(id, tokens.issue("comp"));
+}
+
+BOOST_AUTO_TEST_CASE(token_bound_to_component_and_key)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+    CtrlSessionTokens other(std::chrono::seconds(60), "other");
+    const auto id(tokens.issue("comp"));
+
+    BOOST_CHECK(!tokens.verify("other", id));
+    BOOST_CHECK(!other.verify("comp", id));
+    BOOST_CHECK(!tokens.verify("comp", "garbage"));
+    BOOST_CHECK(!tokens.verify("comp", "1.2"));
+    BOOST_CHECK(!tokens.verify("comp", ""));
+}
+
+BOOST_AUTO_TEST_CASE(token_tampered)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+    const auto id(tokens.issue("comp"));
+
+    // tampered mac
+    auto mac(id);
+    mac.back() = (mac.back() == '0') ? '1' : '0';
+    BOOST_CHECK(!tokens.verify("comp", mac));
+
+    // extended expiry
+    const auto dot(id.find('.'));
+    const auto expiry(boost::lexical_cast<long long>(id.substr(0, dot)));
+    BOOST_CHECK(!tokens.verify
+                ("comp", boost::lexical_cast<std::string>(expiry + 3600)
+                 + id.substr(dot)));
+}
+
+BOOST_AUTO_TEST_CASE(token_expiry)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(0), "key");
+    BOOST_CHECK(!tokens.verify("comp", tokens.issue("comp")));
+
+    CtrlSessionTokens soon(std::chrono::seconds(1), "key");
+    const auto id(soon.issue("comp"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    BOOST_CHECK(!soon.verify("comp", id));
+}
+
+BOOST_AUTO_TEST_CASE(replay_window)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key"
+                             , std::chrono::seconds(30));
+    BOOST_CHECK(tokens.fresh("n1", now()));
+    BOOST_CHECK(!tokens.fresh("n1", now()));
+    BOOST_CHECK(tokens.fresh("n2", now(-20)));
+    BOOST_CHECK(!tokens.fresh("n3", now(-40)));
+    BOOST_CHECK(!tokens.fresh("n4", now(40)));
+    BOOST_CHECK(!tokens.fresh("n5", "yesterday"));
+}
+
+BOOST_AUTO_TEST_CASE(server_full_handshake)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+    CtrlServerHandshake server(lookup, &tokens);
+
+    const auto challenge(server.process("comp"));
+    BOOST_REQUIRE(!challenge.compare(0, 12, "hmac-sha256 "));
+    BOOST_CHECK(!server.authenticated());
+
+    const auto reply(server.process(service::ctrlHmacResponse
+                                    (challenge.substr(12), "comp", Secret)));
+    BOOST_CHECK(server.authenticated());
+    BOOST_CHECK_EQUAL(server.component(), "comp");
+
+    const auto words(split(reply));
+    BOOST_REQUIRE_EQUAL(words.size(), 3u);
+    BOOST_CHECK_EQUAL(words[0], "session");
+    BOOST_CHECK(tokens.verify("comp", words[1]));
+    BOOST_CHECK_EQUAL(words[2], "60");
+
+    BOOST_CHECK_THROW(server.process("again"), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(server_rejects)
+{
+    CtrlServerHandshake unknown(lookup);
+    BOOST_CHECK_THROW(unknown.process("nobody"), std::runtime_error);
+
+    CtrlServerHandshake wrong(lookup);
+    const auto challenge(wrong.process("comp"));
+    BOOST_CHECK_THROW(wrong.process(service::ctrlHmacResponse
+                                    (challenge.substr(12), "comp", "bad"))
+                      , std::runtime_error);
+    BOOST_CHECK(!wrong.authenticated());
+}
+
+BOOST_AUTO_TEST_CASE(server_legacy_opt_in)
+{
+    CtrlServerHandshake strict(lookup);
+    const auto c1(strict.process("comp"));
+    BOOST_CHECK_THROW(strict.process(service::ctrlResponse(c1, Secret))
+                      , std::runtime_error);
+
+    CtrlServerHandshake legacy(lookup, nullptr, true);
+    const auto c2(legacy.process("comp"));
+    BOOST_CHECK(legacy.process(service::ctrlResponse(c2, Secret)).empty());
+    BOOST_CHECK(legacy.authenticated());
+}
+
+BOOST_AUTO_TEST_CASE(server_resume)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+    const auto id(tokens.issue("comp"));
+
+    CtrlServerHandshake server(lookup, &tokens);
+    BOOST_CHECK_EQUAL(server.process(resumeLine(id, "n1", now())), "resumed");
+    BOOST_CHECK(server.authenticated());
+}
+
+BOOST_AUTO_TEST_CASE(server_resume_falls_back_to_challenge)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+    const auto id(tokens.issue("comp"));
+
+    const auto challenged([&](const std::string &line) {
+        CtrlServerHandshake server(lookup, &tokens);
+        const auto reply(server.process(line));
+        return !server.authenticated()
+            && !reply.compare(0, 12, "hmac-sha256 ");
+    });
+
+    // replay of accepted request
+    const auto line(resumeLine(id, "n1", now()));
+    BOOST_CHECK(!challenged(line));
+    BOOST_CHECK(challenged(line));
+
+    // proof made without the secret
+    BOOST_CHECK(challenged(resumeLine(id, "n2", now(), "guess")));
+
+    // stale timestamp
+    BOOST_CHECK(challenged(resumeLine(id, "n3", now(-3600))));
+
+    // forged session id
+    BOOST_CHECK(challenged(resumeLine("1.2.3", "n4", now())));
+
+    // bare session id (no proof)
+    BOOST_CHECK(challenged("comp resume " + id));
+
+    // sessions disabled
+    CtrlServerHandshake server(lookup);
+    BOOST_CHECK(!server.process(resumeLine(id, "n5", now()))
+                .compare(0, 12, "hmac-sha256 "));
+}
+
+BOOST_AUTO_TEST_CASE(client_server_session)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+
+    // first connection: full handshake, session is cached
+    CtrlClientHandshake c1("comp", Secret, "test-peer");
+    CtrlServerHandshake s1(lookup, &tokens);
+    BOOST_CHECK_EQUAL(converse(c1, s1), 2);
+    BOOST_CHECK(s1.authenticated());
+    BOOST_CHECK(!c1.resumed());
+
+    // second connection: single round trip
+    CtrlClientHandshake c2("comp", Secret, "test-peer");
+    CtrlServerHandshake s2(lookup, &tokens);
+    BOOST_CHECK_EQUAL(converse(c2, s2), 1);
+    BOOST_CHECK(s2.authenticated());
+    BOOST_CHECK(c2.resumed());
+
+    // server restarted (new key): falls back to full handshake
+    CtrlSessionTokens restarted(std::chrono::seconds(60), "new key");
+    CtrlClientHandshake c3("comp", Secret, "test-peer");
+    CtrlServerHandshake s3(lookup, &restarted);
+    BOOST_CHECK_EQUAL(converse(c3, s3), 2);
+    BOOST_CHECK(s3.authenticated());
+    BOOST_CHECK(!c3.resumed());
+
+    // and picks new session up
+    CtrlClientHandshake c4("comp", Secret, "test-peer");
+    CtrlServerHandshake s4(lookup, &restarted);
+    BOOST_CHECK_EQUAL(converse(c4, s4), 1);
+    BOOST_CHECK(c4.resumed());
+
+    BOOST_CHECK(c4.failed());
+    BOOST_CHECK(!c4.failed());
+}
+
+BOOST_AUTO_TEST_CASE(client_without_peer_has_no_session)
+{
+    CtrlSessionTokens tokens(std::chrono::seconds(60), "key");
+    for (int i(0); i < 2; ++i) {
+        CtrlClientHandshake client("comp", Secret);
+        CtrlServerHandshake server(lookup, &tokens);
+        BOOST_CHECK_EQUAL(converse(client, server), 2);
+        BOOST_CHECK(server.authenticated());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(client_legacy_server)
+{
+    CtrlClientHandshake client("comp", Secret);
+    BOOST_CHECK_EQUAL(client.start(), "comp");
+    const auto response(client.next({ "legacy-challenge" }));
+    BOOST_REQUIRE(response);
+    BOOST_CHECK_EQUAL(*response, service::ctrlResponse("legacy-challenge"
+                                                       , Secret));
+    BOOST_CHECK(!client.next({}));
+}
@@ -0,0 +1,128 @@
+#define BOOST_TEST_MODULE ctrlresponse
+#include <boost/test/included/unit_test.hpp>
+
+#include <iterator>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include "service/ctrlclient.hpp"
+
+namespace ba = boost::algorithm;
+
+using service::CtrlResponse;
+
+namespace {
+
+typedef std::vector<std::string> Lines;
+
+Lines iterate(const std::string &buffer)
+{
+    CtrlResponse response{std::string(buffer)};
+    Lines lines;
+    for (const auto &line : response) {
+        lines.emplace_back(line.data(), line.size());
+    }
+    return lines;
+}
+
+/** Line splitting used before CtrlResponse was introduced.
+ */
+Lines split(const std::string &buffer)
+{
+    Lines lines;
+    ba::split(lines, buffer, ba::is_any_of("\n"));
+    if (!lines.empty() && lines.back().empty()) { lines.pop_back(); }
+    return lines;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(emptyResponse)
+{
+    CtrlResponse response;
+    BOOST_CHECK(response.empty());
+    BOOST_CHECK(response.begin() == response.end());
+    BOOST_CHECK(response.front().empty());
+    BOOST_CHECK(!response.isError());
+    BOOST_CHECK(response.lines().empty());
+}
+
+BOOST_AUTO_TEST_CASE(trailingNewlineDoesNotStartLine)
+{
+    BOOST_CHECK(iterate("a\nb\n") == (Lines{ "a", "b" }));
+    BOOST_CHECK(iterate("a\n") == (Lines{ "a" }));
+
+    // only one trailing newline is swallowed
+    BOOST_CHECK(iterate("a\n\n") == (Lines{ "a", "" }));
+    BOOST_CHECK(iterate("\n") == (Lines{ "" }));
+}
+
+BOOST_AUTO_TEST_CASE(lastLineWithoutNewline)
+{
+    BOOST_CHECK(iterate("a\nb") == (Lines{ "a", "b" }));
+    BOOST_CHECK(iterate("single") == (Lines{ "single" }));
+}
+
+BOOST_AUTO_TEST_CASE(emptyLinesArePreserved)
+{
+    BOOST_CHECK(iterate("\n\na") == (Lines{ "", "", "a" }));
+    BOOST_CHECK(iterate("a\n\n\nb\n") == (Lines{ "a", "", "", "b" }));
+}
+
+BOOST_AUTO_TEST_CASE(carriageReturnIsKept)
+{
+    // lines are split at LF only, CR stays part of the line as it always did
+    BOOST_CHECK(iterate("a\r\nb\r\n") == (Lines{ "a\r", "b\r" }));
+    BOOST_CHECK(iterate("a\r\n\r\n") == (Lines{ "a\r", "\r" }));
+    BOOST_CHECK(iterate("a\rb") == (Lines{ "a\rb" }));
+}
+
+BOOST_AUTO_TEST_CASE(linesMatchPreviousSplitting)
+{
+    for (const std::string buffer : {
+            "", "\n", "\n\n", "a", "a\n", "a\n\n", "\na", "a\nb", "a\nb\n"
+            , "a\r\nb\r\n", "\r\n", "x\n\ny\n\n\nz", "error: oops\n" })
+    {
+        CtrlResponse response{std::string(buffer)};
+        BOOST_CHECK_MESSAGE(response.lines() == split(buffer)
+                            , "lines() differ for <" << buffer << ">");
+        BOOST_CHECK_EQUAL
+            (std::distance(response.begin(), response.end())
+             , split(buffer).size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(viewsPointIntoBuffer)
+{
+    CtrlResponse response{std::string("first\nsecond\n")};
+    const auto &buffer(response.buffer());
+
+    auto it(response.begin());
+    BOOST_CHECK_EQUAL(*it, "first");
+    BOOST_CHECK((*it).data() == buffer.data());
+
+    auto prev(it++);
+    BOOST_CHECK_EQUAL(*prev, "first");
+    BOOST_CHECK_EQUAL(*it, "second");
+    BOOST_CHECK((*it).data() == buffer.data() + 6);
+
+    ++it;
+    BOOST_CHECK(it == response.end());
+
+    BOOST_CHECK_EQUAL(response.front(), "first");
+}
+
+BOOST_AUTO_TEST_CASE(errorReply)
+{
+    CtrlResponse error{std::string("error: no such command\ndetail\n")};
+    BOOST_CHECK(error.isError());
+    BOOST_CHECK_EQUAL(error.error(), "no such command");
+
+    // only first line counts
+    CtrlResponse ok{std::string("fine\nerror: not really\n")};
+    BOOST_CHECK(!ok.isError());
+
+    CtrlResponse prefix{std::string("error:no space\n")};
+    BOOST_CHECK(!prefix.isError());
+}
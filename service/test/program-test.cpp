@@ -0,0 +1,170 @@
+#define BOOST_TEST_MODULE program
+#include <boost/test/included/unit_test.hpp>
+
+#include <sstream>
+
+#include "service/program.hpp"
+
+namespace po = boost::program_options;
+
+using service::UnrecognizedOptions;
+
+namespace {
+
+/** Parses config content like Program does and adds it to given options.
+ */
+void add(UnrecognizedOptions &un, const std::string &file
+         , const std::string &content
+         , const po::options_description &registered
+         = po::options_description())
+{
+    std::istringstream is(content);
+    un.add(po::parse_config_file(is, registered, true), file, content);
+}
+
+const UnrecognizedOptions::ConfigValue&
+find(const UnrecognizedOptions &un, const std::string &key)
+{
+    const auto *value(un.findConfigOption(key));
+    BOOST_REQUIRE_MESSAGE(value, "missing key " << key);
+    return *value;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(lineOfFirstOccurrence)
+{
+    UnrecognizedOptions un;
+    add(un, "a.conf",
+        "# leading comment\n"
+        "\n"
+        "alpha = 1\n"
+        "   beta=2   # trailing comment\n"
+        "alpha = 3\n"
+        "gamma = x # y = z\n");
+
+    BOOST_CHECK_EQUAL(find(un, "alpha").line, 3);
+    BOOST_CHECK_EQUAL(find(un, "beta").line, 4);
+    BOOST_CHECK_EQUAL(find(un, "gamma").line, 6);
+
+    // repeated key in one file keeps all values in order
+    const auto &alpha(find(un, "alpha").values);
+    BOOST_REQUIRE_EQUAL(alpha.size(), 2);
+    BOOST_CHECK_EQUAL(alpha[0], "1");
+    BOOST_CHECK_EQUAL(alpha[1], "3");
+    BOOST_CHECK_THROW(un.singleConfigOption("alpha"), po::multiple_values);
+    BOOST_CHECK_EQUAL(un.singleConfigOption("gamma"), "x");
+}
+
+BOOST_AUTO_TEST_CASE(crlfAndMissingTrailingNewline)
+{
+    UnrecognizedOptions un;
+    add(un, "a.conf", "alpha = 1\r\n\r\nbeta = 2");
+
+    BOOST_CHECK_EQUAL(find(un, "alpha").line, 1);
+    BOOST_CHECK_EQUAL(find(un, "beta").line, 3);
+    BOOST_CHECK_EQUAL(un.singleConfigOption("beta"), "2");
+}
+
+BOOST_AUTO_TEST_CASE(unknownLineWithoutContent)
+{
+    UnrecognizedOptions un;
+    std::istringstream is("alpha = 1\n");
+    un.add(po::parse_config_file(is, po::options_description(), true)
+           , "a.conf");
+
+    BOOST_CHECK_EQUAL(find(un, "alpha").line, 0);
+    BOOST_CHECK_EQUAL(un.singleConfigOption("alpha"), "1");
+}
+
+BOOST_AUTO_TEST_CASE(sectionPrefixes)
+{
+    UnrecognizedOptions un;
+    add(un, "a.conf",
+        "top = 0\n"
+        "[layer]\n"
+        "name = roads\n"
+        "  [layer.style]  \n"
+        "color = red\n"
+        "[other.]\n"
+        "name = rivers\n");
+
+    BOOST_CHECK_EQUAL(un.singleConfigOption("top"), "0");
+    BOOST_CHECK_EQUAL(un.singleConfigOption("layer.name"), "roads");
+    BOOST_CHECK_EQUAL(un.singleConfigOption("layer.style.color"), "red");
+    BOOST_CHECK_EQUAL(un.singleConfigOption("other.name"), "rivers");
+
+    BOOST_CHECK_EQUAL(find(un, "layer.name").line, 3);
+    BOOST_CHECK_EQUAL(find(un, "layer.style.color").line, 5);
+    BOOST_CHECK_EQUAL(find(un, "other.name").line, 7);
+
+    const auto layer(un.configKeys("layer."));
+    BOOST_CHECK_EQUAL(layer.size(), 2);
+    BOOST_CHECK(layer.count("layer.name"));
+    BOOST_CHECK(layer.count("layer.style.color"));
+
+    BOOST_CHECK_EQUAL(un.configKeys("layer.style.").size(), 1);
+    BOOST_CHECK(un.configKeys("missing.").empty());
+    BOOST_CHECK_EQUAL(un.configKeys().size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(registeredOptionsAreSkipped)
+{
+    po::options_description registered;
+    registered.add_options()
+        ("known", po::value<std::string>(), "")
+        ;
+
+    UnrecognizedOptions un;
+    add(un, "a.conf", "known = 1\nunknown = 2\n", registered);
+
+    BOOST_CHECK(!un.findConfigOption("known"));
+    BOOST_CHECK_EQUAL(find(un, "unknown").line, 2);
+}
+
+BOOST_AUTO_TEST_CASE(firstOccurrenceWinsAcrossFiles)
+{
+    UnrecognizedOptions un;
+    add(un, "first.conf", "alpha = 1\n[s]\nkey = a\n");
+    add(un, "empty.conf", "# nothing unrecognized here\n");
+    add(un, "second.conf", "\n\nalpha = 2\nbeta = 3\n[s]\nkey = b\n");
+    add(un, "third.conf", "beta = 4\ngamma = 5\n");
+
+    // empty file is not recorded
+    BOOST_REQUIRE_EQUAL(un.files().size(), 3);
+    BOOST_REQUIRE_EQUAL(un.config.size(), 3);
+    BOOST_CHECK_EQUAL(un.files()[0], "first.conf");
+    BOOST_CHECK_EQUAL(un.files()[1], "second.conf");
+    BOOST_CHECK_EQUAL(un.files()[2], "third.conf");
+
+    const auto &alpha(find(un, "alpha"));
+    BOOST_CHECK_EQUAL(alpha.values.size(), 1);
+    BOOST_CHECK_EQUAL(alpha.values.front(), "1");
+    BOOST_CHECK_EQUAL(alpha.file, 0);
+    BOOST_CHECK_EQUAL(alpha.line, 1);
+
+    const auto &key(find(un, "s.key"));
+    BOOST_CHECK_EQUAL(key.values.front(), "a");
+    BOOST_CHECK_EQUAL(key.file, 0);
+    BOOST_CHECK_EQUAL(key.line, 3);
+
+    const auto &beta(find(un, "beta"));
+    BOOST_CHECK_EQUAL(beta.values.front(), "3");
+    BOOST_CHECK_EQUAL(beta.file, 1);
+    BOOST_CHECK_EQUAL(beta.line, 4);
+
+    const auto &gamma(find(un, "gamma"));
+    BOOST_CHECK_EQUAL(gamma.file, 2);
+    BOOST_CHECK_EQUAL(gamma.line, 2);
+
+    // values from all files are still available per file
+    BOOST_CHECK_EQUAL(un.config[1].at("alpha").front(), "2");
+    BOOST_CHECK_EQUAL(un.config[2].at("beta").front(), "4");
+
+    // keys are listed once
+    BOOST_CHECK_EQUAL(un.configKeys().size(), 4);
+    BOOST_CHECK_EQUAL(un.seenConfigKeys.size(), 7);
+
+    BOOST_CHECK_THROW(un.singleConfigOption("delta"), po::required_option);
+    BOOST_CHECK_THROW(un.multiConfigOption("delta"), po::required_option);
+}
@@ -0,0 +1,254 @@
+#define BOOST_TEST_MODULE responsefile
+#include <boost/test/included/unit_test.hpp>
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "service/detail/responsefile.hpp"
+
+namespace fs = boost::filesystem;
+
+using service::detail::ResponseFileReader;
+using service::detail::ResponseFileError;
+
+namespace {
+
+typedef ResponseFileReader::Strings Strings;
+typedef ResponseFileReader::Syntax Syntax;
+
+Strings plain(const std::string &content)
+{
+    Strings args;
+    ResponseFileReader::tokenize(content, args, Syntax::plain);
+    return args;
+}
+
+Strings shell(const std::string &content)
+{
+    Strings args;
+    ResponseFileReader::tokenize(content, args, Syntax::shell, "test");
+    return args;
+}
+
+/** Returns error message of failed shell tokenization.
+ */
+std::string shellError(const std::string &content)
+{
+    try {
+        shell(content);
+    } catch (const ResponseFileError &e) {
+        return e.what();
+    }
+    BOOST_ERROR("no error for <" << content << ">");
+    return {};
+}
+
+struct TmpDir {
+    TmpDir()
+        : path(fs::temp_directory_path()
+               / fs::unique_path("responsefile-test-%%%%-%%%%"))
+    {
+        fs::create_directories(path);
+    }
+
+    ~TmpDir() {
+        boost::system::error_code ec;
+        fs::remove_all(path, ec);
+    }
+
+    fs::path write(const fs::path &name, const std::string &content) const {
+        const auto file(path / name);
+        fs::create_directories(file.parent_path());
+        std::ofstream f(file.string(), std::ios::binary | std::ios::trunc);
+        f << content;
+        return file;
+    }
+
+    fs::path path;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(plainSplitsAtSpaceAndNewlines)
+{
+    BOOST_CHECK(plain("") == Strings{});
+    BOOST_CHECK(plain(" \r\n ") == Strings{});
+    BOOST_CHECK(plain("a b\nc\r\nd  e")
+                == (Strings{ "a", "b", "c", "d", "e" }));
+
+    // only space, CR and LF separate arguments
+    BOOST_CHECK(plain("a\tb") == (Strings{ "a\tb" }));
+}
+
+BOOST_AUTO_TEST_CASE(plainTakesEverythingElseLiterally)
+{
+    BOOST_CHECK(plain("'a b'") == (Strings{ "'a", "b'" }));
+    BOOST_CHECK(plain("\"a b\"") == (Strings{ "\"a", "b\"" }));
+    BOOST_CHECK(plain("C:\\data \\") == (Strings{ "C:\\data", "\\" }));
+    BOOST_CHECK(plain("@file # not-a-comment")
+                == (Strings{ "@file", "#", "not-a-comment" }));
+    BOOST_CHECK(plain("it's") == (Strings{ "it's" }));
+}
+
+BOOST_AUTO_TEST_CASE(shellWhitespace)
+{
+    BOOST_CHECK(shell("") == Strings{});
+    BOOST_CHECK(shell(" \t\r\n\f\v") == Strings{});
+    BOOST_CHECK(shell("a\tb\nc\r\nd") == (Strings{ "a", "b", "c", "d" }));
+}
+
+BOOST_AUTO_TEST_CASE(shellQuoting)
+{
+    BOOST_CHECK(shell("'a b' \"c d\"") == (Strings{ "a b", "c d" }));
+
+    // adjacent parts form one argument
+    BOOST_CHECK(shell("a'b c'\"d\"e") == (Strings{ "ab cde" }));
+
+    // empty quotes give empty argument
+    BOOST_CHECK(shell("'' \"\"") == (Strings{ "", "" }));
+
+    // quotes of the other kind are literal
+    BOOST_CHECK(shell("\"it's\" 'say \"hi\"'")
+                == (Strings{ "it's", "say \"hi\"" }));
+
+    // newlines inside quotes are kept
+    BOOST_CHECK(shell("'a\nb' \"c\nd\"") == (Strings{ "a\nb", "c\nd" }));
+}
+
+BOOST_AUTO_TEST_CASE(shellEscapes)
+{
+    // outside quotes: any character
+    BOOST_CHECK(shell("a\\ b \\'c\\' \\\"d \\\\ \\n")
+                == (Strings{ "a b", "'c'", "\"d", "\\", "n" }));
+
+    // inside double quotes: only '"' and '\'
+    BOOST_CHECK(shell("\"\\\" \\\\ \\n \\$\"")
+                == (Strings{ "\" \\ \\n \\$" }));
+
+    // inside single quotes: nothing
+    BOOST_CHECK(shell("'a\\b\\'") == (Strings{ "a\\b\\" }));
+
+    // trailing backslash is literal
+    BOOST_CHECK(shell("a \\") == (Strings{ "a", "\\" }));
+}
+
+BOOST_AUTO_TEST_CASE(shellLineContinuation)
+{
+    BOOST_CHECK(shell("ab\\\ncd") == (Strings{ "abcd" }));
+    BOOST_CHECK(shell("ab\\\r\ncd") == (Strings{ "abcd" }));
+    BOOST_CHECK(shell("a \\\n b") == (Strings{ "a", "b" }));
+    BOOST_CHECK(shell("\"ab\\\ncd\"") == (Strings{ "abcd" }));
+
+    // not inside single quotes
+    BOOST_CHECK(shell("'ab\\\ncd'") == (Strings{ "ab\\\ncd" }));
+}
+
+BOOST_AUTO_TEST_CASE(shellComments)
+{
+    BOOST_CHECK(shell("# whole line\na") == (Strings{ "a" }));
+    BOOST_CHECK(shell("a # rest of line 'x\nb") == (Strings{ "a", "b" }));
+    BOOST_CHECK(shell("a #at end") == (Strings{ "a" }));
+    BOOST_CHECK(shell("#\n#\n") == Strings{});
+
+    // '#' inside an argument, quoted or escaped is literal
+    BOOST_CHECK(shell("a#b") == (Strings{ "a#b" }));
+    BOOST_CHECK(shell("'#a' \"#b\" \\#c")
+                == (Strings{ "#a", "#b", "#c" }));
+
+    // comment ends at newline even after backslash
+    BOOST_CHECK(shell("# comment \\\na") == (Strings{ "a" }));
+}
+
+BOOST_AUTO_TEST_CASE(shellErrorsReportLine)
+{
+    BOOST_CHECK_EQUAL(shellError("a\n'b c")
+                      , "test:2: unterminated single quote.");
+    BOOST_CHECK_EQUAL(shellError("a\n\n\"b\nc")
+                      , "test:3: unterminated double quote.");
+
+    // lines in quotes, continuations and comments are counted
+    BOOST_CHECK_EQUAL(shellError("'a\nb' \\\n# c\n\"")
+                      , "test:4: unterminated double quote.");
+}
+
+BOOST_AUTO_TEST_CASE(tokenizeDoesNotInclude)
+{
+    BOOST_CHECK(shell("@file '@quoted'") == (Strings{ "@file", "@quoted" }));
+}
+
+BOOST_AUTO_TEST_CASE(shellIncludes)
+{
+    TmpDir tmp;
+    const auto top(tmp.write("top.rsp", "a @sub/inner.rsp '@literal' @ z\n"));
+    tmp.write("sub/inner.rsp", "b # comment\n@deeper.rsp c\n");
+    tmp.write("sub/deeper.rsp", "'d e'");
+
+    std::vector<fs::path> loaded;
+    ResponseFileReader reader(Syntax::shell, [&](const fs::path &file
+                                                 , boost::string_view)
+    {
+        loaded.push_back(file.filename());
+    });
+    reader.read(top);
+
+    // relative includes are resolved against including file; lone '@' is
+    // an argument
+    BOOST_CHECK(reader.args()
+                == (Strings{ "a", "b", "d e", "c", "@literal", "@", "z" }));
+    BOOST_CHECK(loaded == (std::vector<fs::path>{
+                "top.rsp", "inner.rsp", "deeper.rsp" }));
+}
+
+BOOST_AUTO_TEST_CASE(includeCycle)
+{
+    TmpDir tmp;
+    const auto a(tmp.write("a.rsp", "x @b.rsp"));
+    tmp.write("b.rsp", "y @a.rsp");
+
+    ResponseFileReader reader(Syntax::shell);
+    try {
+        reader.read(a);
+        BOOST_ERROR("cycle not detected");
+    } catch (const ResponseFileError &e) {
+        BOOST_CHECK(std::string(e.what()).find("include cycle")
+                    != std::string::npos);
+    }
+
+    // same file included twice (not nested) is fine
+    const auto twice(tmp.write("twice.rsp", "@c.rsp @c.rsp"));
+    tmp.write("c.rsp", "c");
+    ResponseFileReader ok(Syntax::shell);
+    ok.read(twice);
+    BOOST_CHECK(ok.args() == (Strings{ "c", "c" }));
+}
+
+BOOST_AUTO_TEST_CASE(missingFile)
+{
+    TmpDir tmp;
+    const auto top(tmp.write("top.rsp", "@missing.rsp"));
+
+    ResponseFileReader reader(Syntax::shell);
+    BOOST_CHECK_THROW(reader.read(top), ResponseFileError);
+    BOOST_CHECK_THROW(ResponseFileReader().read(tmp.path / "none.rsp")
+                      , ResponseFileError);
+}
+
+BOOST_AUTO_TEST_CASE(plainFileIsNotInterpreted)
+{
+    TmpDir tmp;
+    tmp.write("other.rsp", "included");
+    const auto file(tmp.write("top.rsp"
+                              , "@other.rsp 'a b' C:\\data # x\n"));
+
+    ResponseFileReader reader;
+    reader.read(file);
+    BOOST_CHECK(reader.args()
+                == (Strings{ "@other.rsp", "'a", "b'", "C:\\data", "#"
+                            , "x" }));
+
+    ResponseFileReader shellReader(Syntax::shell);
+    shellReader.read(file);
+    BOOST_CHECK(shellReader.args()
+                == (Strings{ "included", "a b", "C:data" }));
+}
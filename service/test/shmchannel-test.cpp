@@ -0,0 +1,278 @@
+#define BOOST_TEST_MODULE shmchannel
+#include <boost/test/included/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+#include <cstring>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "service/shmchannel.hpp"
+
+using service::ShmChannel;
+
+namespace {
+
+typedef ShmChannel::Timeout Timeout;
+
+ShmChannel::Params params(std::size_t capacity, std::size_t messageSize = 64)
+{
+    ShmChannel::Params p;
+    p.capacity = capacity;
+    p.messageSize = messageSize;
+    return p;
+}
+
+/** Checks whether channel's eventfd is readable without consuming it.
+ */
+bool signalled(const ShmChannel &channel, int timeout = 0)
+{
+    ::pollfd pfd{ channel.fd(), POLLIN, 0 };
+    return ::poll(&pfd, 1, timeout) > 0;
+}
+
+/** Message payload: producer id and its sequence number.
+ */
+struct Tag {
+    std::uint32_t producer;
+    std::uint32_t sequence;
+};
+
+bool push(ShmChannel &channel, const Tag &tag)
+{
+    return channel.push(0, &tag, sizeof(tag));
+}
+
+Tag tag(const std::string &data)
+{
+    BOOST_REQUIRE_EQUAL(data.size(), sizeof(Tag));
+    Tag t;
+    std::memcpy(&t, data.data(), sizeof(t));
+    return t;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(capacityIsPowerOfTwo)
+{
+    BOOST_CHECK_EQUAL(ShmChannel(params(5)).capacity(), 8);
+    BOOST_CHECK_EQUAL(ShmChannel(params(8)).capacity(), 8);
+    BOOST_CHECK_EQUAL(ShmChannel(params(1)).capacity(), 2);
+    BOOST_CHECK_EQUAL(ShmChannel(params(4, 100)).messageSize(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(fullAndEmpty)
+{
+    ShmChannel channel(params(4));
+    std::uint32_t type;
+    std::string data;
+
+    BOOST_CHECK_EQUAL(channel.size(), 0);
+    BOOST_CHECK(!channel.pop(type, data, Timeout(0)));
+
+    for (std::uint32_t i(0); i < 4; ++i) {
+        BOOST_CHECK(channel.push(i, std::to_string(i)));
+    }
+    BOOST_CHECK_EQUAL(channel.size(), 4);
+    BOOST_CHECK(!channel.push(99, "overflow"));
+    BOOST_CHECK_EQUAL(channel.size(), 4);
+
+    // one slot freed -> one push succeeds
+    BOOST_REQUIRE(channel.pop(type, data, Timeout(0)));
+    BOOST_CHECK_EQUAL(type, 0);
+    BOOST_CHECK_EQUAL(data, "0");
+    BOOST_CHECK(channel.push(4, "4"));
+    BOOST_CHECK(!channel.push(5, "5"));
+
+    for (std::uint32_t i(1); i <= 4; ++i) {
+        BOOST_REQUIRE(channel.pop(type, data, Timeout(0)));
+        BOOST_CHECK_EQUAL(type, i);
+        BOOST_CHECK_EQUAL(data, std::to_string(i));
+    }
+    BOOST_CHECK(!channel.pop(type, data, Timeout(0)));
+    BOOST_CHECK_EQUAL(channel.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(messageSizeLimit)
+{
+    ShmChannel channel(params(4, 16));
+    std::uint32_t type;
+    std::string data("reused capacity");
+
+    BOOST_CHECK(channel.push(1, std::string(16, 'x')));
+    BOOST_CHECK_THROW(channel.push(2, std::string(17, 'x'))
+                      , std::runtime_error);
+    BOOST_CHECK(channel.push(3, std::string()));
+
+    BOOST_REQUIRE(channel.pop(type, data, Timeout(0)));
+    BOOST_CHECK_EQUAL(data, std::string(16, 'x'));
+    BOOST_REQUIRE(channel.pop(type, data, Timeout(0)));
+    BOOST_CHECK_EQUAL(type, 3);
+    BOOST_CHECK(data.empty());
+    BOOST_CHECK(!channel.pop(type, data, Timeout(0)));
+}
+
+BOOST_AUTO_TEST_CASE(wraparound)
+{
+    // many passes over a tiny ring, with varying fill level
+    ShmChannel channel(params(4));
+    std::uint32_t type;
+    std::string data;
+
+    std::uint32_t pushed(0), popped(0);
+    for (int round(0); round < 1000; ++round) {
+        const auto burst(1 + round % 4);
+        for (int i(0); i < burst; ++i) {
+            BOOST_REQUIRE(channel.push(pushed, std::to_string(pushed)));
+            ++pushed;
+        }
+        while (channel.pop(type, data, Timeout(0))) {
+            BOOST_REQUIRE_EQUAL(type, popped);
+            BOOST_REQUIRE_EQUAL(data, std::to_string(popped));
+            ++popped;
+        }
+    }
+    BOOST_CHECK_EQUAL(pushed, popped);
+    BOOST_CHECK_EQUAL(channel.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(popTimesOut)
+{
+    ShmChannel channel(params(4));
+    std::uint32_t type;
+    std::string data;
+
+    const auto start(std::chrono::steady_clock::now());
+    BOOST_CHECK(!channel.pop(type, data, Timeout(50)));
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= Timeout(50));
+}
+
+BOOST_AUTO_TEST_CASE(eventfdSignalsArmedConsumerOnly)
+{
+    ShmChannel channel(params(4));
+    std::uint32_t type;
+    std::string data;
+
+    // not armed: push does not touch the eventfd
+    BOOST_CHECK(channel.push(1, "a"));
+    BOOST_CHECK(!signalled(channel));
+
+    // data available: arm says do not wait
+    BOOST_CHECK(!channel.arm());
+    BOOST_REQUIRE(channel.pop(type, data, Timeout(0)));
+
+    // empty: armed consumer is woken by the next push
+    BOOST_CHECK(channel.arm());
+    BOOST_CHECK(!signalled(channel));
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        channel.push(2, "b");
+    });
+    BOOST_CHECK(signalled(channel, 5000));
+    producer.join();
+
+    BOOST_REQUIRE(channel.pop(type, data, Timeout(0)));
+    BOOST_CHECK_EQUAL(type, 2);
+    BOOST_CHECK_EQUAL(data, "b");
+    BOOST_CHECK(!channel.pop(type, data, Timeout(0)));
+
+    // re-arming drains the stale signal
+    BOOST_CHECK(channel.arm());
+    BOOST_CHECK(!signalled(channel));
+}
+
+BOOST_AUTO_TEST_CASE(blockingPopWakesUp)
+{
+    ShmChannel channel(params(4));
+    std::uint32_t type;
+    std::string data;
+
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        channel.push(7, "late");
+    });
+
+    BOOST_CHECK(channel.pop(type, data, Timeout(5000)));
+    BOOST_CHECK_EQUAL(type, 7);
+    BOOST_CHECK_EQUAL(data, "late");
+    producer.join();
+}
+
+BOOST_AUTO_TEST_CASE(multipleProducerThreads)
+{
+    const std::uint32_t producers(4), messages(20000);
+
+    // small ring: producers hit full channel often
+    ShmChannel channel(params(16));
+
+    std::vector<std::thread> threads;
+    for (std::uint32_t p(0); p < producers; ++p) {
+        threads.emplace_back([&channel, p, messages]() {
+            for (std::uint32_t i(0); i < messages; ++i) {
+                while (!push(channel, Tag{ p, i })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<std::uint32_t> next(producers, 0);
+    std::uint32_t type;
+    std::string data;
+    for (std::uint32_t i(0); i < producers * messages; ++i) {
+        BOOST_REQUIRE(channel.pop(type, data, Timeout(10000)));
+        const auto t(tag(data));
+        BOOST_REQUIRE(t.producer < producers);
+
+        // FIFO per producer, nothing lost or duplicated
+        BOOST_REQUIRE_EQUAL(t.sequence, next[t.producer]);
+        ++next[t.producer];
+    }
+
+    for (auto &thread : threads) { thread.join(); }
+
+    BOOST_CHECK(!channel.pop(type, data, Timeout(0)));
+    for (auto n : next) { BOOST_CHECK_EQUAL(n, messages); }
+}
+
+BOOST_AUTO_TEST_CASE(multipleProducerProcesses)
+{
+    const std::uint32_t producers(3), messages(5000);
+
+    // must exist before fork
+    ShmChannel channel(params(32));
+
+    std::vector< ::pid_t> children;
+    for (std::uint32_t p(0); p < producers; ++p) {
+        const auto pid(::fork());
+        BOOST_REQUIRE(pid >= 0);
+        if (!pid) {
+            for (std::uint32_t i(0); i < messages; ++i) {
+                while (!push(channel, Tag{ p, i })) { ::sched_yield(); }
+            }
+            ::_exit(EXIT_SUCCESS);
+        }
+        children.push_back(pid);
+    }
+
+    std::vector<std::uint32_t> next(producers, 0);
+    std::uint32_t type;
+    std::string data;
+    for (std::uint32_t i(0); i < producers * messages; ++i) {
+        BOOST_REQUIRE(channel.pop(type, data, Timeout(10000)));
+        const auto t(tag(data));
+        BOOST_REQUIRE(t.producer < producers);
+        BOOST_REQUIRE_EQUAL(t.sequence, next[t.producer]);
+        ++next[t.producer];
+    }
+
+    for (auto pid : children) {
+        int status(0);
+        BOOST_CHECK_EQUAL(::waitpid(pid, &status, 0), pid);
+        BOOST_CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+    }
+
+    BOOST_CHECK(!channel.pop(type, data, Timeout(0)));
+}
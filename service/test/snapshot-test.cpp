@@ -0,0 +1,325 @@
+#define BOOST_TEST_MODULE snapshot
+#include <boost/test/included/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+
+#include "service/snapshot.hpp"
+
+namespace fs = boost::filesystem;
+
+using service::Snapshot;
+using service::Snapshots;
+using service::SnapshotReader;
+using service::SnapshotWriter;
+
+namespace {
+
+const std::string Identity("snapshot-test 1.0");
+
+/** Temporary directory removed at the end of the test.
+ */
+struct TmpDir {
+    TmpDir()
+        : path(fs::temp_directory_path()
+               / fs::unique_path("snapshot-test-%%%%-%%%%"))
+    {
+        fs::create_directories(path);
+    }
+
+    ~TmpDir() {
+        boost::system::error_code ec;
+        fs::remove_all(path, ec);
+    }
+
+    fs::path file(const std::string &name = "snapshot") const {
+        return path / name;
+    }
+
+    fs::path path;
+};
+
+std::string readFile(const fs::path &path)
+{
+    std::ifstream f(path.string(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f)
+                       , std::istreambuf_iterator<char>());
+}
+
+void writeFile(const fs::path &path, const std::string &content)
+{
+    std::ofstream f(path.string(), std::ios::binary | std::ios::trunc);
+    f.write(content.data(), content.size());
+}
+
+/** Flips one byte of given file.
+ */
+void corrupt(const fs::path &path, std::size_t offset)
+{
+    auto content(readFile(path));
+    BOOST_REQUIRE(offset < content.size());
+    content[offset] ^= 0x5a;
+    writeFile(path, content);
+}
+
+/** Large block with non-repeating content.
+ */
+std::string block(std::size_t size, char seed)
+{
+    std::string data(size, '\0');
+    for (std::size_t i(0); i < size; ++i) {
+        data[i] = char(seed + i * 131 + (i >> 12));
+    }
+    return data;
+}
+
+/** Two sections: "numbers" and "text".
+ */
+void addProviders(Snapshots &snapshots)
+{
+    snapshots.add("numbers", 1, [](SnapshotWriter &w) {
+            for (std::uint64_t i(0); i < 100; ++i) { w.write(i * i); }
+        });
+    snapshots.add("text", 2, [](SnapshotWriter &w) {
+            w.write(std::string("hello snapshot"));
+            w.write(std::string());
+            w.write(std::int32_t(-7));
+        });
+}
+
+fs::path saved(const TmpDir &tmp)
+{
+    Snapshots snapshots;
+    addProviders(snapshots);
+    const auto path(tmp.file());
+    snapshots.save(path, Identity);
+    return path;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(roundTrip)
+{
+    TmpDir tmp;
+    const auto path(saved(tmp));
+    BOOST_CHECK(!fs::exists(tmp.file("snapshot.tmp")));
+
+    auto snapshot(Snapshot::open(path, Identity));
+    BOOST_REQUIRE(snapshot);
+    BOOST_CHECK(snapshot->sections()
+                == (std::vector<std::string>{ "numbers", "text" }));
+    BOOST_CHECK(std::abs(std::time(nullptr) - snapshot->created()) < 60);
+
+    auto numbers(snapshot->section("numbers", 1));
+    BOOST_REQUIRE(numbers);
+    BOOST_CHECK_EQUAL(numbers->version(), 1);
+    BOOST_CHECK_EQUAL(numbers->size(), 100 * sizeof(std::uint64_t));
+    for (std::uint64_t i(0); i < 100; ++i) {
+        BOOST_REQUIRE_EQUAL(numbers->read<std::uint64_t>(), i * i);
+    }
+    BOOST_CHECK_EQUAL(numbers->remaining(), 0);
+    BOOST_CHECK_THROW(numbers->read(1), std::runtime_error);
+
+    auto text(snapshot->section("text", 2));
+    BOOST_REQUIRE(text);
+    BOOST_CHECK_EQUAL(text->readString(), "hello snapshot");
+    BOOST_CHECK_EQUAL(text->readString(), "");
+    BOOST_CHECK_EQUAL(text->read<std::int32_t>(), -7);
+
+    // sections are 64-byte aligned in the mapping
+    BOOST_CHECK(!(reinterpret_cast<std::uintptr_t>(text->data()) % 64));
+
+    BOOST_CHECK(!snapshot->section("missing", 1));
+    BOOST_CHECK(!snapshot->section("text", 3));
+}
+
+BOOST_AUTO_TEST_CASE(largeBlocksBypassBuffer)
+{
+    TmpDir tmp;
+
+    // larger than, equal to and just below the 1 MiB write buffer,
+    // interleaved with small writes so that buffered data must go first
+    const auto huge(block(3 * (1 << 20) + 17, 'a'));
+    const auto exact(block(1 << 20, 'b'));
+    const auto almost(block((1 << 20) - 1, 'c'));
+
+    Snapshots snapshots;
+    snapshots.add("blocks", 1, [&](SnapshotWriter &w) {
+            w.write(std::uint32_t(1));
+            w.write(huge.data(), huge.size());
+            w.write(std::uint32_t(2));
+            w.write(exact.data(), exact.size());
+            w.write(almost.data(), almost.size());
+            w.write(std::uint32_t(3));
+            BOOST_CHECK_EQUAL(w.size(), 12 + huge.size() + exact.size()
+                              + almost.size());
+        });
+    snapshots.add("after", 1, [](SnapshotWriter &w) {
+            w.write(std::string("tail"));
+        });
+    snapshots.save(tmp.file(), Identity);
+
+    auto snapshot(Snapshot::open(tmp.file(), Identity));
+    BOOST_REQUIRE(snapshot);
+
+    auto r(snapshot->section("blocks", 1));
+    BOOST_REQUIRE(r);
+    const auto read([&](std::size_t size) {
+            return std::string(static_cast<const char*>(r->read(size))
+                               , size);
+        });
+
+    BOOST_CHECK_EQUAL(r->read<std::uint32_t>(), 1);
+    BOOST_CHECK(read(huge.size()) == huge);
+    BOOST_CHECK_EQUAL(r->read<std::uint32_t>(), 2);
+    BOOST_CHECK(read(exact.size()) == exact);
+    BOOST_CHECK(read(almost.size()) == almost);
+    BOOST_CHECK_EQUAL(r->read<std::uint32_t>(), 3);
+    BOOST_CHECK_EQUAL(r->remaining(), 0);
+
+    auto after(snapshot->section("after", 1));
+    BOOST_REQUIRE(after);
+    BOOST_CHECK_EQUAL(after->readString(), "tail");
+}
+
+BOOST_AUTO_TEST_CASE(sectionChecksumMismatch)
+{
+    TmpDir tmp;
+    const auto path(saved(tmp));
+
+    // corrupt payload of "text" section only
+    const auto content(readFile(path));
+    const auto offset(content.find("hello snapshot"));
+    BOOST_REQUIRE(offset != std::string::npos);
+    corrupt(path, offset + 3);
+
+    // header and table are intact -> file opens
+    auto snapshot(Snapshot::open(path, Identity));
+    BOOST_REQUIRE(snapshot);
+
+    BOOST_CHECK(!snapshot->section("text", 2));
+    // result is remembered
+    BOOST_CHECK(!snapshot->section("text", 2));
+    BOOST_CHECK(snapshot->section("numbers", 1));
+}
+
+BOOST_AUTO_TEST_CASE(tableChecksumMismatch)
+{
+    TmpDir tmp;
+    const auto path(saved(tmp));
+
+    // section table is at the end of the file
+    corrupt(path, fs::file_size(path) - 10);
+    BOOST_CHECK(!Snapshot::open(path, Identity));
+}
+
+BOOST_AUTO_TEST_CASE(headerCorruption)
+{
+    TmpDir tmp;
+
+    // magic
+    auto path(saved(tmp));
+    corrupt(path, 0);
+    BOOST_CHECK(!Snapshot::open(path, Identity));
+
+    // creation time is covered by header checksum
+    path = saved(tmp);
+    corrupt(path, 16);
+    BOOST_CHECK(!Snapshot::open(path, Identity));
+}
+
+BOOST_AUTO_TEST_CASE(truncatedFile)
+{
+    TmpDir tmp;
+    const auto path(saved(tmp));
+    const auto content(readFile(path));
+
+    // without table, within header and empty file
+    for (std::size_t size : { content.size() - 1, content.size() / 2
+                , std::size_t(20), std::size_t(0) })
+    {
+        writeFile(path, content.substr(0, size));
+        BOOST_CHECK_MESSAGE(!Snapshot::open(path, Identity)
+                            , "truncated to " << size << " bytes opened");
+    }
+
+    // intact again
+    writeFile(path, content);
+    BOOST_CHECK(Snapshot::open(path, Identity));
+}
+
+BOOST_AUTO_TEST_CASE(identityAndMissingFile)
+{
+    TmpDir tmp;
+    const auto path(saved(tmp));
+
+    BOOST_CHECK(!Snapshot::open(path, "snapshot-test 1.1"));
+    BOOST_CHECK(!Snapshot::open(tmp.file("missing"), Identity));
+    BOOST_CHECK(Snapshot::open(path, Identity, 3600));
+}
+
+BOOST_AUTO_TEST_CASE(failedSaveKeepsPreviousSnapshot)
+{
+    TmpDir tmp;
+    const auto path(saved(tmp));
+    const auto before(readFile(path));
+
+    Snapshots snapshots;
+    snapshots.add("broken", 1, [](SnapshotWriter &w) {
+            w.write(std::uint64_t(42));
+            throw std::runtime_error("save failed");
+        });
+    BOOST_CHECK_THROW(snapshots.save(path, Identity), std::runtime_error);
+
+    BOOST_CHECK(!fs::exists(tmp.file("snapshot.tmp")));
+    BOOST_CHECK(readFile(path) == before);
+}
+
+BOOST_AUTO_TEST_CASE(providersAreLoadedOnce)
+{
+    TmpDir tmp;
+    const auto path(saved(tmp));
+    auto snapshot(Snapshot::open(path, Identity));
+    BOOST_REQUIRE(snapshot);
+
+    int numbers(0), text(0), stale(0);
+    const auto noSave([](SnapshotWriter&) {});
+
+    Snapshots snapshots;
+    // registered before restore -> loaded by restore()
+    snapshots.add("numbers", 1, noSave, [&](SnapshotReader &r) {
+            BOOST_CHECK_EQUAL(r.read<std::uint64_t>(), 0);
+            BOOST_CHECK_EQUAL(r.read<std::uint64_t>(), 1);
+            ++numbers;
+        });
+    // version mismatch -> never loaded
+    snapshots.add("text", 1, noSave, [&](SnapshotReader&) { ++stale; });
+    BOOST_CHECK_EQUAL(numbers, 0);
+
+    snapshots.restore(snapshot);
+    BOOST_CHECK_EQUAL(numbers, 1);
+    BOOST_CHECK(snapshots.snapshot() == snapshot);
+
+    // registered after restore -> loaded right away
+    Snapshots late;
+    late.restore(snapshot);
+    late.add("text", 2, noSave, [&](SnapshotReader &r) {
+            BOOST_CHECK_EQUAL(r.readString(), "hello snapshot");
+            ++text;
+        });
+    BOOST_CHECK_EQUAL(text, 1);
+
+    // restoring again does not reload
+    snapshots.restore(snapshot);
+    BOOST_CHECK_EQUAL(numbers, 1);
+    BOOST_CHECK_EQUAL(stale, 0);
+
+    snapshots.restore({});
+    BOOST_CHECK(!snapshots.snapshot());
+
+    BOOST_CHECK_THROW(snapshots.add("numbers", 1, noSave), std::logic_error);
+    BOOST_CHECK_THROW(snapshots.add(std::string(48, 'x'), 1, noSave)
+                      , std::logic_error);
+}
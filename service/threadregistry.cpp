@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#  include <sys/syscall.h>
+#endif
+
+#include <map>
+#include <mutex>
+#include <atomic>
+
+#include <boost/optional.hpp>
+
+#include "dbglog/dbglog.hpp"
+#include "utility/atfork.hpp"
+
+#include "threadregistry.hpp"
+
+namespace service {
+
+::pid_t currentThreadId()
+{
+#ifdef __linux__
+    return ::syscall(SYS_gettid);
+#else
+    static std::atomic< ::pid_t> last(0);
+    static thread_local ::pid_t tid(0);
+    if (!tid) { tid = ++last; }
+    return tid;
+#endif
+}
+
+namespace {
+
+::pid_t currentTid() { return currentThreadId(); }
+
+/** Kernel name of main thread is the name of the whole process on Linux.
+ */
+bool isMainThread(::pid_t tid)
+{
+#ifdef __linux__
+    return tid == ::getpid();
+#else
+    (void) tid;
+    return ::pthread_main_np();
+#endif
+}
+
+void setKernelName(const std::string &name)
+{
+#if defined(__APPLE__)
+    ::pthread_setname_np(name.substr(0, 15).c_str());
+#else
+    ::pthread_setname_np(::pthread_self(), name.substr(0, 15).c_str());
+#endif
+}
+
+struct Entry {
+    std::string name;
+    std::string role;
+};
+
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    void add(::pid_t tid, const Entry &entry) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        threads_[tid] = entry;
+    }
+
+    void remove(::pid_t tid) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        threads_.erase(tid);
+    }
+
+    std::vector<RegisteredThread> list() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        std::vector<RegisteredThread> out;
+        for (const auto &item : threads_) {
+            out.push_back({ item.first, item.second.name, item.second.role });
+        }
+        return out;
+    }
+
+private:
+    Registry() {
+        utility::AtFork::add(this, [this](utility::AtFork::Event event)
+        {
+            switch (event) {
+            case utility::AtFork::prepare:
+                mutex_.lock();
+                break;
+
+            case utility::AtFork::parent:
+                mutex_.unlock();
+                break;
+
+            case utility::AtFork::child:
+                atForkChild();
+                mutex_.unlock();
+                break;
+            }
+        });
+    }
+
+    ~Registry() { utility::AtFork::remove(this); }
+
+    /** Only forking thread survives fork, and under new tid.
+     */
+    void atForkChild() {
+        const auto fthreads(threads_.find(threadTid));
+        boost::optional<Entry> self;
+        if (fthreads != threads_.end()) { self = fthreads->second; }
+        threads_.clear();
+        threadTid = currentTid();
+        if (self) { threads_[threadTid] = *self; }
+    }
+
+    std::mutex mutex_;
+    std::map< ::pid_t, Entry> threads_;
+
+public:
+    static thread_local ::pid_t threadTid;
+};
+
+/** Tid of registered thread, used to find it in child after fork.
+ */
+thread_local ::pid_t Registry::threadTid(0);
+
+} // namespace
+
+ThreadRegistration registerThread(const std::string &name
+                                  , const std::string &role)
+{
+    dbglog::thread_id(name);
+    if (!isMainThread(currentTid())) { setKernelName(name); }
+    return listThread(name, role);
+}
+
+ThreadRegistration listThread(const std::string &name
+                              , const std::string &role)
+{
+    const auto tid(currentTid());
+    Registry::threadTid = tid;
+    Registry::instance().add(tid, { name, role });
+    return ThreadRegistration(true);
+}
+
+ThreadRegistration& ThreadRegistration::operator=(ThreadRegistration &&other)
+{
+    if (this != &other) {
+        if (active_) { Registry::instance().remove(currentTid()); }
+        active_ = other.active_;
+        other.active_ = false;
+    }
+    return *this;
+}
+
+ThreadRegistration::~ThreadRegistration()
+{
+    if (active_) { Registry::instance().remove(currentTid()); }
+}
+
+std::vector<RegisteredThread> registeredThreads()
+{
+    return Registry::instance().list();
+}
+
+} // namespace service
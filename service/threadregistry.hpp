@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef shared_service_threadregistry_hpp_included_
+#define shared_service_threadregistry_hpp_included_
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace service {
+
+/** Registration of a named thread. Unregisters the calling thread on
+ *  destruction, therefore it must be destroyed by the registered thread.
+ */
+class ThreadRegistration {
+public:
+    ThreadRegistration() : active_(false) {}
+    ThreadRegistration(ThreadRegistration &&other)
+        : active_(other.active_)
+    {
+        other.active_ = false;
+    }
+
+    ThreadRegistration& operator=(ThreadRegistration &&other);
+
+    ThreadRegistration(const ThreadRegistration&) = delete;
+    ThreadRegistration& operator=(const ThreadRegistration&) = delete;
+
+    ~ThreadRegistration();
+
+private:
+    friend ThreadRegistration listThread(const std::string&
+                                         , const std::string&);
+    explicit ThreadRegistration(bool active) : active_(active) {}
+
+    bool active_;
+};
+
+/** Registers calling thread under given name and role (e.g. pool name).
+ *
+ *  Sets dbglog thread id and kernel thread name (pthread_setname_np,
+ *  truncated to 15 characters). Kernel name is not changed for process'
+ *  main thread since it would rename the whole process.
+ *
+ *  After fork, only the forking thread is kept in the child's registry.
+ */
+ThreadRegistration registerThread(const std::string &name
+                                  , const std::string &role
+                                  = std::string());
+
+/** Adds calling thread to the registry only; its dbglog thread id and
+ *  kernel name are left untouched (e.g. main thread owned by application).
+ */
+ThreadRegistration listThread(const std::string &name
+                              , const std::string &role
+                              = std::string());
+
+/** Id of calling thread: kernel thread id (gettid) on Linux, process-wide
+ *  sequence number elsewhere. Used as key in the registry.
+ *
+ *  Async-signal-safe on Linux; elsewhere only in threads that have already
+ *  called it (e.g. registered threads).
+ */
+::pid_t currentThreadId();
+
+struct RegisteredThread {
+    ::pid_t tid;
+    std::string name;
+    std::string role;
+};
+
+/** Snapshot of registered threads.
+ */
+std::vector<RegisteredThread> registeredThreads();
+
+} // namespace service
+
+#endif // shared_service_threadregistry_hpp_included_
@@ -0,0 +1,223 @@
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include "utility/buildsys.hpp"
+
+#include "service/cmdline.hpp"
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double ms(const Clock::duration &d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+struct Results {
+    std::size_t keys = 0;
+    Clock::duration lookup = Clock::duration();
+    Clock::duration sections = Clock::duration();
+    std::size_t sectionKeys = 0;
+};
+
+/** Program loading generated configuration with unrecognized options, as
+ *  services routing whole layer definitions through the config do.
+ */
+class Probe : public service::Cmdline {
+public:
+    Probe(Results &results, std::size_t sections)
+        : service::Cmdline("service-config-probe", BUILD_TARGET_VERSION
+                           , (service::DISABLE_EXCESSIVE_LOGGING
+                              | service::ENABLE_CONFIG_UNRECOGNIZED_OPTIONS))
+        , results_(results), sections_(sections)
+    {}
+
+private:
+    void configuration(po::options_description&, po::options_description&
+                       , po::positional_options_description&) override {}
+
+    void configure(const po::variables_map&) override {}
+
+    service::UnrecognizedParser::optional
+    configure(const po::variables_map&
+              , const service::UnrecognizedOptions &un) override
+    {
+        const auto &keys(un.configKeys());
+        results_.keys = keys.size();
+
+        auto start(Clock::now());
+        for (const auto &key : keys) { un.singleConfigOption(key); }
+        results_.lookup = Clock::now() - start;
+
+        start = Clock::now();
+        for (std::size_t s(0); s < sections_; ++s) {
+            results_.sectionKeys
+                += un.configKeys("layer" + std::to_string(s) + ".").size();
+        }
+        results_.sections = Clock::now() - start;
+
+        return {};
+    }
+
+    int run() override { return EXIT_SUCCESS; }
+
+    Results &results_;
+    std::size_t sections_;
+};
+
+class Bench : public service::Cmdline {
+public:
+    Bench()
+        : service::Cmdline("service-config-bench", BUILD_TARGET_VERSION
+                           , service::DISABLE_EXCESSIVE_LOGGING)
+    {}
+
+private:
+    void configuration(po::options_description &cmdline
+                       , po::options_description &config
+                       , po::positional_options_description &pd)
+        override;
+
+    void configure(const po::variables_map &vars) override;
+
+    bool help(std::ostream &out, const std::string &what) const
+        override;
+
+    int run() override;
+
+    std::size_t keys_ = 100000;
+    std::size_t sections_ = 1000;
+    std::size_t files_ = 1;
+    std::size_t runs_ = 1;
+    bool dump_ = false;
+    fs::path dir_ = fs::temp_directory_path();
+};
+
+void Bench::configuration(po::options_description &cmdline
+                          , po::options_description &config
+                          , po::positional_options_description &pd)
+{
+    cmdline.add_options()
+        ("keys", po::value(&keys_)->default_value(keys_)
+         , "Total number of unrecognized config keys.")
+        ("sections", po::value(&sections_)->default_value(sections_)
+         , "Number of config sections the keys are spread over.")
+        ("files", po::value(&files_)->default_value(files_)
+         , "Number of config files the sections are spread over.")
+        ("runs", po::value(&runs_)->default_value(runs_)
+         , "Number of measured startups; best and average are reported.")
+        ("dump", po::value(&dump_)->default_value(dump_)
+         ->implicit_value(true)
+         , "Enable log.dumpConfig in the probe (output is discarded).")
+        ("dir", po::value(&dir_)->default_value(dir_)
+         , "Directory for generated config files.")
+        ;
+
+    (void) config;
+    (void) pd;
+}
+
+void Bench::configure(const po::variables_map &vars)
+{
+    (void) vars;
+    sections_ = std::max(sections_, std::size_t(1));
+    files_ = std::max(std::min(files_, sections_), std::size_t(1));
+    runs_ = std::max(runs_, std::size_t(1));
+}
+
+bool Bench::help(std::ostream &out, const std::string &what) const
+{
+    if (what.empty()) {
+        out << ("Measures startup of a program loading large configuration "
+                "(optionally split into multiple files) with unrecognized "
+                "options and lookup of all its keys.\n");
+        return true;
+    }
+    return false;
+}
+
+int Bench::run()
+{
+    // generate config files
+    std::vector<fs::path> files;
+    std::size_t size(0);
+    for (std::size_t f(0); f < files_; ++f) {
+        files.push_back(dir_ / ("config-bench-" + std::to_string(::getpid())
+                                + "-" + std::to_string(f) + ".conf"));
+        std::ofstream os(files.back().string());
+        for (std::size_t s(f); s < sections_; s += files_) {
+            os << "\n# layer " << s << "\n[layer" << s << "]\n";
+            for (std::size_t k(s); k < keys_; k += sections_) {
+                os << "key" << k << " = value of key " << k << "\n";
+            }
+        }
+        size += os.tellp();
+    }
+
+    std::vector<std::string> args{ "service-config-probe" };
+    for (const auto &file : files) {
+        args.push_back("--config");
+        args.push_back(file.string());
+    }
+    if (dump_) {
+        args.push_back("--log.dumpConfig");
+        args.push_back("--log.console=false");
+    }
+
+    Results results;
+    Clock::duration best(Clock::duration::max()), total(0);
+    int code(EXIT_SUCCESS);
+    for (std::size_t run(0); !code && (run < runs_); ++run) {
+        std::vector<char*> argv;
+        auto runArgs(args);
+        for (auto &arg : runArgs) { argv.push_back(&arg[0]); }
+
+        results = Results();
+        const auto start(Clock::now());
+        code = Probe(results, sections_)(int(argv.size()), argv.data());
+        const auto startup(Clock::now() - start);
+        best = std::min(best, startup);
+        total += startup;
+    }
+
+    for (const auto &file : files) {
+        boost::system::error_code ec;
+        fs::remove(file, ec);
+    }
+
+    if (code) { return code; }
+
+    const auto average(total / runs_);
+    std::cout << results.keys << " keys in " << sections_ << " sections, "
+              << files_ << " files, " << (size >> 10) << " KiB"
+              << (dump_ ? ", dumped" : "") << "\n"
+              << "startup:  " << ms(best) << " ms best, " << ms(average)
+              << " ms average of " << runs_ << " ("
+              << ((size / 1048576.0) / (ms(best) / 1000.0)) << " MiB/s)\n"
+              << "lookup:   " << ms(results.lookup) << " ms ("
+              << (1e6 * ms(results.lookup) / std::max(results.keys
+                                                      , std::size_t(1)))
+              << " ns/key)\n"
+              << "sections: " << ms(results.sections) << " ms ("
+              << results.sectionKeys << " keys)\n";
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    return Bench()(argc, argv);
+}
@@ -1,3 +1,5 @@
+#include <fstream>
+
 #include <boost/filesystem/path.hpp>
 
 #include <readline/readline.h>
@@ -9,6 +11,8 @@
 
 #include "service/cmdline.hpp"
 #include "service/ctrlclient.hpp"
+#include "service/ctrlfanout.hpp"
+#include "service/ctrlbatch.hpp"
 
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
@@ -39,10 +43,24 @@ private:
 
     int runCommand();
 
-    fs::path connect_;
+    int runBatch();
+
+    int runFanOut();
+
+    /** Multiple targets or a glob pattern given.
+     */
+    bool multiTarget() const;
+
+    std::vector<std::string> connect_;
     fs::path history_;
 
     boost::optional<std::string> command_;
+    boost::optional<std::string> batch_;
+
+    service::CtrlBatch::Params batchParams_;
+
+    service::CtrlFanOut::Params fanOut_;
+    bool group_ = false;
 };
 
 void CtrlClient::configuration(po::options_description &cmdline
@@ -51,14 +69,35 @@ void CtrlClient::configuration(po::options_description &cmdline
 {
     cmdline.add_options()
         ("connect", po::value(&connect_)->required()
-         , "Path to UNIX socket to connect to.")
+         , "Path to UNIX socket to connect to. Multiple paths or glob "
+         "patterns (e.g. /run/*/ctrl) run the command on all matching "
+         "sockets (requires --command).")
         ("history", po::value(&history_)
          , "Path to a history file.")
         ("command,c", po::value(&command_)
          , "Executes command from input string.")
+        ("batch", po::value(&batch_)
+         , "Executes commands read from given file (- for stdin), one "
+         "command per line, over single connection.")
+        ("continue-on-error", po::bool_switch(&batchParams_.continueOnError)
+         , "Do not stop batch on first failed command.")
+        ("pipeline-depth", po::value(&batchParams_.depth)
+         ->default_value(batchParams_.depth)
+         , "Maximum number of batch commands sent ahead of replies "
+         "(values above 1 require --continue-on-error).")
+        ("parallel", po::value(&fanOut_.parallel)
+         ->default_value(fanOut_.parallel)
+         , "Maximum number of targets contacted at once in multi-target "
+         "mode.")
+        ("timeout", po::value<long>()
+         ->default_value(fanOut_.timeout.count())
+         , "Per-target timeout (in milliseconds) in multi-target mode.")
+        ("group", po::bool_switch(&group_)
+         , "Group output by target instead of prefixing each line with "
+         "target in multi-target mode.")
         ;
 
-    pd.add("connect", 1)
+    pd.add("connect", -1)
         ;
 
     (void) config;
@@ -66,7 +105,25 @@ void CtrlClient::configuration(po::options_description &cmdline
 
 void CtrlClient::configure(const po::variables_map &vars)
 {
-    (void) vars;
+    fanOut_.timeout = std::chrono::milliseconds(vars["timeout"].as<long>());
+
+    if (multiTarget() && !command_) {
+        throw po::error("Multiple targets can be used only with --command.");
+    }
+
+    if (batch_ && command_) {
+        throw po::error("Options --batch and --command are mutually "
+                        "exclusive.");
+    }
+
+    if ((batchParams_.depth > 1) && !batchParams_.continueOnError) {
+        throw po::error("Option --pipeline-depth above 1 requires "
+                        "--continue-on-error.");
+    }
+
+    if (!batchParams_.depth) {
+        throw po::error("Option --pipeline-depth must be positive.");
+    }
 }
 
 bool CtrlClient::help(std::ostream &out, const std::string &what) const
@@ -74,6 +131,12 @@ bool CtrlClient::help(std::ostream &out, const std::string &what) const
     if (what.empty()) {
         // program help
         out << ("Service control interface cmdline client\n"
+                "\n"
+                "In multi-target mode, exit status is 0 when all targets "
+                "succeeded, 1 when\n"
+                "command failed on some target and 2 when some target was "
+                "unreachable or\n"
+                "timed out.\n"
                 );
 
         return true;
@@ -82,10 +145,20 @@ bool CtrlClient::help(std::ostream &out, const std::string &what) const
     return false;
 }
 
+bool CtrlClient::multiTarget() const
+{
+    return ((connect_.size() > 1)
+            || (connect_.front().find_first_of("*?[") != std::string::npos));
+}
+
 int CtrlClient::run()
 {
+    if (multiTarget()) { return runFanOut(); }
+
     if (command_) { return runCommand(); }
 
+    if (batch_) { return runBatch(); }
+
     return runInteractive();
 }
 
@@ -98,10 +171,10 @@ int CtrlClient::runInteractive()
     }
 
     const auto name(fs::path(service::Program::argv0()).filename().string());
-    const auto prompt(utility::format("ctrl:%s>", connect_.string()));
+    const auto prompt(utility::format("ctrl:%s>", connect_.front()));
 
     try {
-        service::CtrlClient client(connect_, name);
+        service::CtrlClient client(connect_.front(), name);
 
         for (;;) {
             auto buf(::readline(prompt.c_str()));
@@ -140,7 +213,7 @@ int CtrlClient::runInteractive()
 int CtrlClient::runCommand()
 {
     try {
-        service::CtrlClient client(connect_, name);
+        service::CtrlClient client(connect_.front(), name);
 
         for (const auto &line : client.command(*command_)) {
             std::cout << line << "\n";
@@ -155,6 +228,55 @@ int CtrlClient::runCommand()
     return EXIT_SUCCESS;
 }
 
+int CtrlClient::runBatch()
+{
+    try {
+        std::vector<std::string> commands;
+        if (*batch_ == "-") {
+            commands = service::CtrlBatch::load(std::cin);
+        } else {
+            std::ifstream f(*batch_);
+            if (!f) {
+                std::cerr << name << ": unable to open batch file <"
+                          << *batch_ << ">." << std::endl;
+                return EXIT_FAILURE;
+            }
+            commands = service::CtrlBatch::load(f);
+        }
+
+        service::CtrlClient client(connect_.front(), name);
+        return service::CtrlBatch(batchParams_)
+            .run(client, commands, std::cout, std::cerr);
+    } catch (const std::exception &e) {
+        std::cerr << name << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+int CtrlClient::runFanOut()
+{
+    std::vector<std::string> targets;
+    try {
+        targets = service::CtrlFanOut::expand(connect_);
+    } catch (const std::exception &e) {
+        std::cerr << name << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (targets.empty()) {
+        std::cerr << name << ": no target to connect to." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    fanOut_.name = name;
+    const auto outcomes(service::CtrlFanOut(fanOut_).run(targets, *command_));
+    service::CtrlFanOut::print(std::cout, std::cerr, outcomes
+                               , (group_
+                                  ? service::CtrlFanOut::Format::group
+                                  : service::CtrlFanOut::Format::prefix));
+    return service::CtrlFanOut::exitCode(outcomes);
+}
+
 } // namespace
 
 int main(int argc, char *argv[])
@@ -0,0 +1,181 @@
+#include <cstdlib>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <iostream>
+#include <sstream>
+
+#include <boost/asio/streambuf.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include "utility/buildsys.hpp"
+
+#include "service/cmdline.hpp"
+#include "service/ctrlclient.hpp"
+
+namespace po = boost::program_options;
+
+namespace {
+
+std::atomic<std::size_t> allocations(0);
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+class Bench : public service::Cmdline {
+public:
+    Bench()
+        : service::Cmdline("service-ctrlresponse-bench", BUILD_TARGET_VERSION
+                           , service::DISABLE_EXCESSIVE_LOGGING)
+    {}
+
+private:
+    void configuration(po::options_description &cmdline
+                       , po::options_description &config
+                       , po::positional_options_description &pd)
+        override;
+
+    void configure(const po::variables_map &vars) override;
+
+    bool help(std::ostream &out, const std::string &what) const
+        override;
+
+    int run() override;
+
+    std::size_t size_ = 10 << 20;
+    int iterations_ = 10;
+};
+
+void Bench::configuration(po::options_description &cmdline
+                          , po::options_description &config
+                          , po::positional_options_description &pd)
+{
+    cmdline.add_options()
+        ("size", po::value(&size_)->default_value(size_)
+         , "Response size in bytes.")
+        ("iterations", po::value(&iterations_)->default_value(iterations_)
+         , "Number of iterations.")
+        ;
+
+    (void) config;
+    (void) pd;
+}
+
+void Bench::configure(const po::variables_map &vars)
+{
+    (void) vars;
+}
+
+bool Bench::help(std::ostream &out, const std::string &what) const
+{
+    if (what.empty()) {
+        out << ("Measures parsing of large ctrl responses: legacy "
+                "getline/split path vs. CtrlResponse\n");
+        return true;
+    }
+    return false;
+}
+
+/** Generates stat-like response block including terminator.
+ */
+std::string generate(std::size_t size)
+{
+    std::ostringstream os;
+    for (std::size_t i(0); os.tellp() < std::streamoff(size); ++i) {
+        os << "counter." << i << ".requests: " << (i * 7919) << '\n';
+    }
+    os << '\4';
+    return os.str();
+}
+
+template <typename Body>
+void measure(const char *what, int iterations, std::size_t &sink
+             , const Body &body)
+{
+    const auto a0(allocations.load());
+    const auto t0(std::chrono::steady_clock::now());
+    for (int i(0); i < iterations; ++i) { sink += body(); }
+    const auto t1(std::chrono::steady_clock::now());
+    const auto a1(allocations.load());
+
+    std::cout
+        << what << ": "
+        << (std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0)
+            .count() / iterations)
+        << " us/iteration, "
+        << ((a1 - a0) / iterations) << " allocations/iteration\n";
+}
+
+int Bench::run()
+{
+    const auto raw(generate(size_));
+    std::cout << "response: " << raw.size() << " bytes\n";
+
+    std::size_t sink(0);
+
+    // legacy: streambuf -> getline -> split into vector of strings
+    measure("legacy", iterations_, sink, [&]() -> std::size_t
+    {
+        boost::asio::streambuf sb;
+        std::ostream(&sb) << raw;
+
+        std::istream is(&sb);
+        std::string response;
+        std::getline(is, response, '\4');
+
+        std::vector<std::string> lines;
+        boost::algorithm::split(lines, response
+                                , boost::algorithm::is_any_of("\n"));
+        if (!lines.empty() && lines.back().empty()) { lines.pop_back(); }
+
+        std::size_t total(0);
+        for (const auto &line : lines) { total += line.size(); }
+        return total;
+    });
+
+    // CtrlResponse: single buffer, lazy line views
+    measure("CtrlResponse", iterations_, sink, [&]() -> std::size_t
+    {
+        std::string buffer(raw);
+        buffer.pop_back();
+        service::CtrlResponse response(std::move(buffer));
+
+        std::size_t total(0);
+        for (const auto &line : response) { total += line.size(); }
+        return total;
+    });
+
+    // CtrlResponse converted to legacy result
+    measure("CtrlResponse::lines()", iterations_, sink, [&]() -> std::size_t
+    {
+        std::string buffer(raw);
+        buffer.pop_back();
+        const auto lines(service::CtrlResponse(std::move(buffer)).lines());
+
+        std::size_t total(0);
+        for (const auto &line : lines) { total += line.size(); }
+        return total;
+    });
+
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    return Bench()(argc, argv);
+}
@@ -1,4 +1,7 @@
+#include <fstream>
+
 #include <boost/filesystem/path.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 #include <readline/readline.h>
 #include <readline/history.h>
@@ -10,8 +13,11 @@
 
 #include "service/cmdline.hpp"
 #include "service/netctrlclient.hpp"
+#include "service/ctrlfanout.hpp"
+#include "service/ctrlbatch.hpp"
 
 namespace fs = boost::filesystem;
+namespace ba = boost::algorithm;
 namespace po = boost::program_options;
 
 namespace {
@@ -44,10 +50,20 @@ private:
 
     int runCommand(const service::NetCtrlClient::Params &params);
 
-    std::string connect_;
+    int runBatch(const service::NetCtrlClient::Params &params);
+
+    int runFanOut();
+
+    std::vector<std::string> connect_;
     fs::path history_;
 
     boost::optional<std::string> command_;
+    boost::optional<std::string> batch_;
+
+    service::CtrlBatch::Params batchParams_;
+
+    service::CtrlFanOut::Params fanOut_;
+    bool group_ = false;
 };
 
 void CtrlClient::configuration(po::options_description &cmdline
@@ -56,14 +72,34 @@ void CtrlClient::configuration(po::options_description &cmdline
 {
     cmdline.add_options()
         ("connect", po::value(&connect_)->required()
-         , "TCP endpoint to connect to.")
+         , "TCP endpoint to connect to. Multiple endpoints run the command "
+         "on all of them (requires --command).")
         ("history", po::value(&history_)
          , "Path to a history file.")
         ("command,c", po::value(&command_)
          , "Executes command from input string.")
+        ("batch", po::value(&batch_)
+         , "Executes commands read from given file (- for stdin), one "
+         "command per line, over single connection.")
+        ("continue-on-error", po::bool_switch(&batchParams_.continueOnError)
+         , "Do not stop batch on first failed command.")
+        ("pipeline-depth", po::value(&batchParams_.depth)
+         ->default_value(batchParams_.depth)
+         , "Maximum number of batch commands sent ahead of replies "
+         "(values above 1 require --continue-on-error).")
+        ("parallel", po::value(&fanOut_.parallel)
+         ->default_value(fanOut_.parallel)
+         , "Maximum number of targets contacted at once in multi-target "
+         "mode.")
+        ("timeout", po::value<long>()
+         ->default_value(fanOut_.timeout.count())
+         , "Per-target timeout (in milliseconds) in multi-target mode.")
+        ("group", po::bool_switch(&group_)
+         , "Group output by target instead of prefixing each line with "
+         "target in multi-target mode.")
         ;
 
-    pd.add("connect", 1)
+    pd.add("connect", -1)
         ;
 
     (void) config;
@@ -71,7 +107,32 @@ void CtrlClient::configuration(po::options_description &cmdline
 
 void CtrlClient::configure(const po::variables_map &vars)
 {
-    (void) vars;
+    fanOut_.timeout = std::chrono::milliseconds(vars["timeout"].as<long>());
+
+    if ((connect_.size() > 1) && !command_) {
+        throw po::error("Multiple targets can be used only with --command.");
+    }
+
+    // fan-out would take anything else for a UNIX socket path
+    for (const auto &target : connect_) {
+        if (!ba::istarts_with(target, "ctrl:")) {
+            throw po::error("Every --connect target must be a ctrl:// URI.");
+        }
+    }
+
+    if (batch_ && command_) {
+        throw po::error("Options --batch and --command are mutually "
+                        "exclusive.");
+    }
+
+    if ((batchParams_.depth > 1) && !batchParams_.continueOnError) {
+        throw po::error("Option --pipeline-depth above 1 requires "
+                        "--continue-on-error.");
+    }
+
+    if (!batchParams_.depth) {
+        throw po::error("Option --pipeline-depth must be positive.");
+    }
 }
 
 bool CtrlClient::help(std::ostream &out, const std::string &what) const
@@ -79,6 +140,12 @@ bool CtrlClient::help(std::ostream &out, const std::string &what) const
     if (what.empty()) {
         // program help
         out << ("Network-enabled service control interface cmdline client\n"
+                "\n"
+                "In multi-target mode, exit status is 0 when all targets "
+                "succeeded, 1 when\n"
+                "command failed on some target and 2 when some target was "
+                "unreachable or\n"
+                "timed out.\n"
                 );
 
         return true;
@@ -89,18 +156,22 @@ bool CtrlClient::help(std::ostream &out, const std::string &what) const
 
 int CtrlClient::run()
 {
+    if (connect_.size() > 1) { return runFanOut(); }
+
     service::NetCtrlClient::Params params;
 
     try {
-        params = { connect_ };
+        params = { connect_.front() };
     } catch (const std::exception &e) {
         std::cerr << name << ": " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
 
-    return (command_
-            ? runCommand(params)
-            : runInteractive(params));
+    if (command_) { return runCommand(params); }
+
+    if (batch_) { return runBatch(params); }
+
+    return runInteractive(params);
 }
 
 int CtrlClient::runInteractive(const service::NetCtrlClient::Params &params)
@@ -168,6 +239,49 @@ int CtrlClient::runCommand(const service::NetCtrlClient::Params &params)
     return EXIT_SUCCESS;
 }
 
+int CtrlClient::runBatch(const service::NetCtrlClient::Params &params)
+{
+    try {
+        std::vector<std::string> commands;
+        if (*batch_ == "-") {
+            commands = service::CtrlBatch::load(std::cin);
+        } else {
+            std::ifstream f(*batch_);
+            if (!f) {
+                std::cerr << params.component << ": unable to open batch "
+                          << "file <" << *batch_ << ">." << std::endl;
+                return EXIT_FAILURE;
+            }
+            commands = service::CtrlBatch::load(f);
+        }
+
+        service::NetCtrlClient client(params);
+        return service::CtrlBatch(batchParams_)
+            .run(client, commands, std::cout, std::cerr);
+    } catch (const std::exception &e) {
+        std::cerr << params.component << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+int CtrlClient::runFanOut()
+{
+    fanOut_.name = name;
+    service::CtrlFanOut::Outcomes outcomes;
+    try {
+        outcomes = service::CtrlFanOut(fanOut_).run(connect_, *command_);
+    } catch (const std::exception &e) {
+        std::cerr << name << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    service::CtrlFanOut::print(std::cout, std::cerr, outcomes
+                               , (group_
+                                  ? service::CtrlFanOut::Format::group
+                                  : service::CtrlFanOut::Format::prefix));
+    return service::CtrlFanOut::exitCode(outcomes);
+}
+
 } // namespace
 
 int main(int argc, char *argv[])
@@ -0,0 +1,243 @@
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/tokenizer.hpp>
+
+#include "utility/buildsys.hpp"
+
+#include "service/cmdline.hpp"
+#include "service/detail/responsefile.hpp"
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+typedef std::vector<std::string> Strings;
+
+double ms(const Clock::duration &d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+/** Batch tool taking its inputs as positional arguments, typically passed
+ *  via a generated response file.
+ */
+class Probe : public service::Cmdline {
+public:
+    Probe(std::size_t &inputs)
+        : service::Cmdline("service-responsefile-probe"
+                           , BUILD_TARGET_VERSION
+                           , service::DISABLE_EXCESSIVE_LOGGING
+                           | service::ENABLE_SHELL_RESPONSE_FILES)
+        , inputs_(inputs)
+    {}
+
+private:
+    void configuration(po::options_description &cmdline
+                       , po::options_description&
+                       , po::positional_options_description &pd) override
+    {
+        cmdline.add_options()
+            ("input", po::value(&input_)->required(), "Input files.")
+            ;
+        pd.add("input", -1);
+    }
+
+    void configure(const po::variables_map&) override {
+        inputs_ = input_.size();
+    }
+
+    int run() override { return EXIT_SUCCESS; }
+
+    std::size_t &inputs_;
+    Strings input_;
+};
+
+class Bench : public service::Cmdline {
+public:
+    Bench()
+        : service::Cmdline("service-responsefile-bench", BUILD_TARGET_VERSION
+                           , service::DISABLE_EXCESSIVE_LOGGING)
+    {}
+
+private:
+    void configuration(po::options_description &cmdline
+                       , po::options_description &config
+                       , po::positional_options_description &pd)
+        override;
+
+    void configure(const po::variables_map &vars) override;
+
+    bool help(std::ostream &out, const std::string &what) const
+        override;
+
+    int run() override;
+
+    std::size_t paths_ = 500000;
+    std::size_t files_ = 1;
+    std::size_t runs_ = 3;
+    bool program_ = false;
+    fs::path dir_ = fs::temp_directory_path();
+};
+
+void Bench::configuration(po::options_description &cmdline
+                          , po::options_description &config
+                          , po::positional_options_description &pd)
+{
+    cmdline.add_options()
+        ("paths", po::value(&paths_)->default_value(paths_)
+         , "Number of input paths in the response files.")
+        ("files", po::value(&files_)->default_value(files_)
+         , "Number of response files; first one includes the rest.")
+        ("runs", po::value(&runs_)->default_value(runs_)
+         , "Number of measured runs; best one is reported.")
+        ("program", po::value(&program_)->default_value(program_)
+         ->implicit_value(true)
+         , "Measure also full program startup with the response file; "
+         "NB: boost::program_options command line parsing is quadratic in "
+         "number of arguments, use with lower --paths.")
+        ("dir", po::value(&dir_)->default_value(dir_)
+         , "Directory for generated response files.")
+        ;
+
+    (void) config;
+    (void) pd;
+}
+
+void Bench::configure(const po::variables_map &vars)
+{
+    (void) vars;
+    files_ = std::max(files_, std::size_t(1));
+    runs_ = std::max(runs_, std::size_t(1));
+}
+
+bool Bench::help(std::ostream &out, const std::string &what) const
+{
+    if (what.empty()) {
+        out << ("Measures tokenization of large generated response files "
+                "(@file) with quoting and nested includes.\n");
+        return true;
+    }
+    return false;
+}
+
+template <typename Function>
+Clock::duration best(std::size_t runs, Function function)
+{
+    auto best(Clock::duration::max());
+    for (std::size_t run(0); run < runs; ++run) {
+        const auto start(Clock::now());
+        function();
+        best = std::min(best, Clock::now() - start);
+    }
+    return best;
+}
+
+int Bench::run()
+{
+    // generate response files: first one includes all others
+    std::vector<fs::path> files;
+    std::size_t size(0);
+    for (std::size_t f(0); f < files_; ++f) {
+        files.push_back(dir_ / ("responsefile-bench-"
+                                + std::to_string(::getpid())
+                                + "-" + std::to_string(f) + ".rsp"));
+    }
+    for (std::size_t f(0); f < files_; ++f) {
+        std::ofstream os(files[f].string());
+        if (!f) {
+            for (std::size_t i(1); i < files_; ++i) {
+                os << '@' << files[i].filename().string() << '\n';
+            }
+        }
+        for (std::size_t p(f); p < paths_; p += files_) {
+            const auto dir("/data/input/tile-" + std::to_string(p % 997));
+            switch (p % 8) {
+            case 0: os << '"' << dir << "/with space " << p << ".tif\"\n";
+                break;
+            case 1: os << dir << "/with\\ escape-" << p << ".tif\n"; break;
+            default: os << dir << "/plain-" << p << ".tif\n"; break;
+            }
+        }
+        size += os.tellp();
+    }
+
+    std::size_t args(0);
+    const auto reader(best(runs_, [&]() {
+        service::detail::ResponseFileReader r
+            (service::detail::ResponseFileReader::Syntax::shell);
+        r.read(files.front());
+        args = r.args().size();
+    }));
+
+    // baseline: what the previous implementation did (no quoting, no
+    // includes)
+    std::size_t baselineArgs(0);
+    const auto baseline(best(runs_, [&]() {
+        Strings out;
+        for (const auto &file : files) {
+            std::ifstream is(file.string());
+            typedef boost::char_separator<char> Separator;
+            typedef std::istreambuf_iterator<char> Iterator;
+            typedef boost::tokenizer<Separator, Iterator> Tokenizer;
+            Tokenizer tokenizer(Iterator(is), Iterator()
+                                , Separator(" \n\r"));
+            std::copy(tokenizer.begin(), tokenizer.end()
+                      , std::back_inserter(out));
+        }
+        baselineArgs = out.size();
+    }));
+
+    std::size_t inputs(0);
+    int code(EXIT_SUCCESS);
+    auto program(Clock::duration::zero());
+    if (program_) {
+        program = best(runs_, [&]() {
+            std::string argv0("service-responsefile-probe");
+            std::string rsp("@" + files.front().string());
+            char *argv[] = { &argv0[0], &rsp[0] };
+            if (!code) { code = Probe(inputs)(2, argv); }
+        });
+    }
+
+    for (const auto &file : files) {
+        boost::system::error_code ec;
+        fs::remove(file, ec);
+    }
+
+    if (code) { return code; }
+
+    const auto mibs([&](const Clock::duration &d) {
+        return (size / 1048576.0) / (ms(d) / 1000.0);
+    });
+
+    std::cout << paths_ << " paths in " << files_ << " files, "
+              << (size >> 10) << " KiB\n"
+              << "reader:   " << ms(reader) << " ms, " << mibs(reader)
+              << " MiB/s (" << args << " args)\n"
+              << "baseline: " << ms(baseline) << " ms, " << mibs(baseline)
+              << " MiB/s (" << baselineArgs
+              << " args, boost::tokenizer, no quoting)\n";
+    if (program_) {
+        std::cout << "program:  " << ms(program) << " ms (" << inputs
+                  << " inputs)\n";
+    }
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    return Bench()(argc, argv);
+}
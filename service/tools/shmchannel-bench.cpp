@@ -0,0 +1,220 @@
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include <unistd.h>
+#include <sched.h>
+#include <sys/wait.h>
+
+#include "utility/buildsys.hpp"
+
+#include "service/cmdline.hpp"
+#include "service/runninguntilsignalled.hpp"
+#include "service/pipenotifier.hpp"
+#include "service/shmchannel.hpp"
+
+namespace po = boost::program_options;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+typedef service::PipeNotifier::Role Role;
+
+class Bench : public service::Cmdline {
+public:
+    Bench()
+        : service::Cmdline("service-shmchannel-bench", BUILD_TARGET_VERSION
+                           , service::DISABLE_EXCESSIVE_LOGGING)
+    {}
+
+private:
+    void configuration(po::options_description &cmdline
+                       , po::options_description &config
+                       , po::positional_options_description &pd)
+        override;
+
+    void configure(const po::variables_map &vars) override;
+
+    bool help(std::ostream &out, const std::string &what) const
+        override;
+
+    int run() override;
+
+    std::size_t messages_ = 1000000;
+    std::size_t size_ = 64;
+    std::size_t pings_ = 100000;
+};
+
+void Bench::configuration(po::options_description &cmdline
+                          , po::options_description &config
+                          , po::positional_options_description &pd)
+{
+    cmdline.add_options()
+        ("messages", po::value(&messages_)->default_value(messages_)
+         , "Number of messages sent in throughput test.")
+        ("size", po::value(&size_)->default_value(size_)
+         , "Message size in bytes (at least 8).")
+        ("pings", po::value(&pings_)->default_value(pings_)
+         , "Number of round trips in latency test.")
+        ;
+
+    (void) config;
+    (void) pd;
+}
+
+void Bench::configure(const po::variables_map &vars)
+{
+    (void) vars;
+    size_ = std::max(size_, sizeof(std::uint64_t));
+}
+
+bool Bench::help(std::ostream &out, const std::string &what) const
+{
+    if (what.empty()) {
+        out << ("Measures master<->child message throughput and round trip "
+                "latency: PipeNotifier vs. ShmChannel\n");
+        return true;
+    }
+    return false;
+}
+
+/** Transport adaptors: child -> master (up) and master -> child (down).
+ */
+struct Pipe {
+    Pipe(utility::Runnable &runnable) : pn(runnable) {}
+
+    void up(const std::string &data) { pn.send(Role::slave, { 0, data }); }
+    void upFlush() { pn.flush(Role::slave); }
+    void down(const std::string &data) {
+        pn.send(Role::master, { 0, data });
+        pn.flush(Role::master);
+    }
+
+    void receiveUp(std::string &data) { data = pn.receive(Role::master)->data; }
+    void receiveDown(std::string &data) {
+        data = pn.receive(Role::slave)->data;
+    }
+
+    service::PipeNotifier pn;
+};
+
+struct Shm {
+    Shm(std::size_t size) : upChannel(params(size)), downChannel(params(size))
+    {}
+
+    static service::ShmChannel::Params params(std::size_t size) {
+        service::ShmChannel::Params p;
+        p.capacity = 4096;
+        p.messageSize = size;
+        return p;
+    }
+
+    static void push(service::ShmChannel &channel, const std::string &data) {
+        while (!channel.push(0, data)) { ::sched_yield(); }
+    }
+
+    void up(const std::string &data) { push(upChannel, data); }
+    void upFlush() {}
+    void down(const std::string &data) { push(downChannel, data); }
+
+    void receiveUp(std::string &data) {
+        std::uint32_t type;
+        upChannel.pop(type, data);
+    }
+
+    void receiveDown(std::string &data) {
+        std::uint32_t type;
+        downChannel.pop(type, data);
+    }
+
+    service::ShmChannel upChannel;
+    service::ShmChannel downChannel;
+};
+
+template <typename Transport>
+void measure(const char *what, Transport &t, std::size_t messages
+             , std::size_t size, std::size_t pings)
+{
+    const auto pid(::fork());
+    if (pid < 0) {
+        std::cerr << "fork failed: " << std::strerror(errno) << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (!pid) {
+        // child: burst, then echo pings
+        std::string data(size, 'x');
+        for (std::size_t i(0); i < messages; ++i) { t.up(data); }
+        t.upFlush();
+
+        for (std::size_t i(0); i < pings; ++i) {
+            t.receiveDown(data);
+            t.up(data);
+            t.upFlush();
+        }
+        ::_exit(EXIT_SUCCESS);
+    }
+
+    std::string data;
+
+    const auto t0(Clock::now());
+    for (std::size_t i(0); i < messages; ++i) { t.receiveUp(data); }
+    const auto t1(Clock::now());
+
+    std::vector<Clock::duration> rtt;
+    rtt.reserve(pings);
+    std::string ping(size, 'p');
+    for (std::size_t i(0); i < pings; ++i) {
+        const auto start(Clock::now());
+        t.down(ping);
+        t.receiveUp(data);
+        rtt.push_back(Clock::now() - start);
+    }
+
+    ::waitpid(pid, nullptr, 0);
+
+    const auto seconds(std::chrono::duration<double>(t1 - t0).count());
+    std::cout << what << ": " << std::size_t(messages / seconds)
+              << " messages/s";
+
+    if (!rtt.empty()) {
+        std::sort(rtt.begin(), rtt.end());
+        const auto us([&](double q) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>
+                (rtt[std::size_t(q * (rtt.size() - 1))]).count() / 1000.0;
+        });
+        std::cout << ", round trip p50 " << us(.5) << " us, p99 "
+                  << us(.99) << " us, max " << us(1.) << " us";
+    }
+    std::cout << std::endl;
+}
+
+int Bench::run()
+{
+    service::RunningUntilSignalled running;
+
+    std::cout << messages_ << " messages of " << size_ << " bytes, "
+              << pings_ << " round trips\n";
+
+    {
+        Pipe pipe(running);
+        measure("PipeNotifier", pipe, messages_, size_, pings_);
+    }
+
+    {
+        Shm shm(size_);
+        measure("ShmChannel", shm, messages_, size_, pings_);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    return Bench()(argc, argv);
+}
@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dbglog/dbglog.hpp"
+
+#include "tunables.hpp"
+
+namespace service {
+
+void Tunables::add(const std::string &name, const Getter &get
+                   , const Setter &set, const std::string &help)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!tunables_.insert(Map::value_type(name, { get, set, help }))
+        .second)
+    {
+        LOGTHROW(err2, std::logic_error)
+            << "Tunable <" << name << "> already registered.";
+    }
+}
+
+const Tunables::Tunable& Tunables::find(const std::string &name) const
+{
+    auto ftunables(tunables_.find(name));
+    if (ftunables == tunables_.end()) {
+        throw std::out_of_range("unknown tunable <" + name + ">");
+    }
+    return ftunables->second;
+}
+
+bool Tunables::has(const std::string &name) const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return tunables_.count(name);
+}
+
+std::string Tunables::get(const std::string &name) const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return find(name).get();
+}
+
+std::string Tunables::set(const std::string &name, const std::string &value)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    const auto &tunable(find(name));
+
+    auto old(tunable.get());
+    try {
+        tunable.set(value);
+    } catch (const boost::bad_lexical_cast&) {
+        throw std::invalid_argument("invalid value <" + value
+                                    + "> of tunable <" + name + ">");
+    } catch (const std::invalid_argument &e) {
+        throw std::invalid_argument("invalid value <" + value
+                                    + "> of tunable <" + name + ">: "
+                                    + e.what());
+    }
+
+    LOG(info3) << "Tunable <" << name << "> changed: <" << old
+               << "> -> <" << tunable.get() << ">.";
+    return old;
+}
+
+void Tunables::list(std::ostream &os) const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (const auto &item : tunables_) {
+        os << item.first << " = " << item.second.get();
+        if (!item.second.help.empty()) {
+            os << "    # " << item.second.help;
+        }
+        os << '\n';
+    }
+}
+
+} // namespace service
@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef service_tunables_hpp_included_
+#define service_tunables_hpp_included_
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#include <functional>
+
+#include <boost/lexical_cast.hpp>
+
+namespace service {
+
+/** Registry of named runtime-tunable parameters.
+ *
+ *  A tunable is either an atomic variable owned by the caller (hot path
+ *  reads it directly via load(), the registry only stores new values) or a
+ *  pair of getter and validating setter. Values are exchanged as strings.
+ *
+ *  Every change is logged with old and new value. Registry operations are
+ *  serialized; tunables must outlive the registry (or at least its use).
+ */
+class Tunables {
+public:
+    typedef std::function<std::string()> Getter;
+
+    /** Applies new value; throws std::invalid_argument (or
+     *  boost::bad_lexical_cast) when the value is not acceptable.
+     */
+    typedef std::function<void(const std::string &value)> Setter;
+
+    /** Validator of atomic tunable's value.
+     */
+    template <typename T> using Check = std::function<bool(const T&)>;
+
+    /** Registers tunable with given getter and setter. Throws
+     *  std::logic_error if name is already registered.
+     */
+    void add(const std::string &name, const Getter &get, const Setter &set
+             , const std::string &help = std::string());
+
+    /** Registers atomic tunable. New value is parsed, checked (if check is
+     *  given) and stored.
+     */
+    template <typename T>
+    void add(const std::string &name, std::atomic<T> &value
+             , const std::string &help = std::string()
+             , const Check<T> &check = Check<T>());
+
+    /** Check for inclusive range [min, max].
+     */
+    template <typename T>
+    static Check<T> range(T min, T max) {
+        return [min, max](const T &value) {
+            return (value >= min) && (value <= max);
+        };
+    }
+
+    bool has(const std::string &name) const;
+
+    /** Returns current value. Throws std::out_of_range on unknown name.
+     */
+    std::string get(const std::string &name) const;
+
+    /** Sets new value and returns the old one. Throws std::out_of_range on
+     *  unknown name and std::invalid_argument on invalid value.
+     */
+    std::string set(const std::string &name, const std::string &value);
+
+    /** Prints "name = value" line (followed by help if any) for each
+     *  tunable, sorted by name.
+     */
+    void list(std::ostream &os) const;
+
+    template <typename T> static T parse(const std::string &value);
+    template <typename T> static std::string format(const T &value);
+
+private:
+    struct Tunable {
+        Getter get;
+        Setter set;
+        std::string help;
+    };
+
+    typedef std::map<std::string, Tunable> Map;
+
+    const Tunable& find(const std::string &name) const;
+
+    mutable std::mutex mutex_;
+    Map tunables_;
+};
+
+// inlines
+
+template <typename T>
+T Tunables::parse(const std::string &value)
+{
+    return boost::lexical_cast<T>(value);
+}
+
+template <>
+inline bool Tunables::parse<bool>(const std::string &value)
+{
+    if ((value == "true") || (value == "on") || (value == "yes")
+        || (value == "1"))
+    {
+        return true;
+    }
+    if ((value == "false") || (value == "off") || (value == "no")
+        || (value == "0"))
+    {
+        return false;
+    }
+    throw boost::bad_lexical_cast();
+}
+
+template <typename T>
+std::string Tunables::format(const T &value)
+{
+    return boost::lexical_cast<std::string>(value);
+}
+
+template <>
+inline std::string Tunables::format<bool>(const bool &value)
+{
+    return value ? "true" : "false";
+}
+
+template <typename T>
+void Tunables::add(const std::string &name, std::atomic<T> &value
+                   , const std::string &help, const Check<T> &check)
+{
+    add(name
+        , [&value]() { return format(value.load()); }
+        , [&value, check](const std::string &str)
+        {
+            const auto v(parse<T>(str));
+            if (check && !check(v)) {
+                throw std::invalid_argument("value out of range");
+            }
+            value.store(v);
+        }
+        , help);
+}
+
+} // namespace service
+
+#endif // service_tunables_hpp_included_